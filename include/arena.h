@@ -0,0 +1,31 @@
+#ifndef _ARENA_H
+#define _ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_BLOCK_SIZE (64 * 1024)    // default size of one block, bigger allocations get a block of their own
+#define ARENA_ALIGNMENT 16
+
+struct ArenaBlock;
+
+typedef struct ArenaBlock {
+    struct ArenaBlock* next;
+    size_t used;
+    size_t capacity;
+    _Alignas(ARENA_ALIGNMENT) char data[];  // blocks come from malloc, which aligns at least this much
+} ArenaBlock;
+
+// bump allocator. nothing is freed on its own, everything goes at once with arena_reset or arena_free
+typedef struct {
+    ArenaBlock* first;
+    ArenaBlock* current;    // block allocations are currently served from
+} Arena;
+
+void* arena_alloc(Arena* arena, size_t size);
+void* arena_calloc(Arena* arena, size_t count, size_t size);
+void* arena_grow(Arena* arena, void* old, size_t old_size, size_t new_size);
+void arena_reset(Arena* arena);
+void arena_free(Arena* arena);
+
+
+#endif //_ARENA_H
@@ -0,0 +1,31 @@
+#ifndef _CLASSIFY_H
+#define _CLASSIFY_H
+
+#include "ss.h"
+#include "table.h"
+
+typedef enum {
+    COLOUR_NONE = 0,
+    COLOUR_RED,
+    COLOUR_GREEN,
+    COLOUR_YELLOW,
+    COLOUR_BLUE,
+    COLOUR_MAGENTA,
+    COLOUR_CYAN,
+    COLOUR_BLACK,
+    COLOUR_WHITE,
+    COLOUR_COUNT
+} ColourId;
+
+// what a token turned out to be, along with its value if it has one
+typedef struct {
+    CellKind kind;
+    double number;      // KIND_NUM only
+    ColourId colour;    // KIND_COLOUR only
+} TokenClass;
+
+TokenClass classify_token(StringStruct token);
+StringStruct colour_code(ColourId colour);
+
+
+#endif //_CLASSIFY_H
@@ -0,0 +1,32 @@
+#ifndef _COLOUR_LAYER_H
+#define _COLOUR_LAYER_H
+
+#include <stdint.h>
+
+#include "table.h"
+#include "classify.h"
+
+// stretch of same coloured cells in one row
+typedef struct {
+    uint32_t col;           // first cell of the run
+    uint32_t length : 29;
+    uint32_t colour : 3;    // ColourId - 1, runs are never COLOUR_NONE
+} ColourRun;
+
+// runs of a row sorted by column, never overlapping, and neighbouring runs of the same colour are always merged
+typedef struct ColourRow {
+    ColourRun* runs;
+    int count;
+    int capacity;
+} ColourRow;
+
+ColourRow* colour_row(Table* table, int row);
+ColourId colour_at(Table* table, int row, int col);
+void set_colour(Table* table, int row, int col, ColourId colour);
+void build_glyphs(Writer* writer, int width);
+void render_colour_run(Writer* writer, ColourId colour, const int* widths, int count);
+void reserve_colours(Table* table, int tile_rows);
+void free_colours(Table* table);
+
+
+#endif //_COLOUR_LAYER_H
@@ -0,0 +1,27 @@
+#ifndef _COLUMNS_H
+#define _COLUMNS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "table.h"
+
+// widest cells of a column, kept up to date as cells change so laying the table out never has to look at every cell
+typedef struct ColumnWidth {
+    uint32_t widest;
+    uint32_t count;         // cells that are widest wide, 0 when a rescan left it unknown
+    bool stale;             // the widest cells all got narrower, measured again the next time it is asked for
+} ColumnWidth;
+
+void store_value(Table* table, int row, int col, double value);
+void clear_value(Table* table, int row, int col);
+double value_at(Table* table, int row, int col);
+size_t column_width(Tile* tile, int col);
+uint32_t cell_width(Table* table, const Cell* cell, int row, int col);
+void refresh_width(Table* table, int row, int col);
+void count_widths(Table* table);
+uint32_t widest_in_column(Table* table, int col);
+void reserve_widths(Table* table, int tile_cols);
+
+
+#endif //_COLUMNS_H
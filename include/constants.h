@@ -3,12 +3,21 @@
 
 #define DECIMAL_PLACES 3
 #define EXTRA_CELL_SPACE 2
-#define GRAPH_NODE_BUFFER_SIZE 32           // node buffer of one entire expression contains this many nodes
-#define NODE_LIST_SIZE 32                   // node stack contains this many nodes
-#define SYNTAX_ERRORS_BUFF_SIZE 2048         // buffer for printing all syntax errors
-#define GRAPH_CYCLE_BUFFER_SIZE 256              // buffer for printing a dependency cycle
-#define INVALID_DEPENDENCY_BUFFER_SIZE 256  // buffer for printing invalid dependency
-#define EQUATION_TOKENS                 16
+#define MIN_CELL_WIDTH 3                    // columns of nothing but empty and coloured cells
+#define GRAPH_LIST_INITIAL_SIZE 32          // graph starts with room for this many nodes and grows as needed
+#define RECSTACK_INITIAL_SIZE 32            // dfs path starts with room for this many nodes and grows as needed
+#define GRAPH_INDEX_INITIAL_SIZE 64         // slots of the graph's cell to node index, a power of two
+#define FORMULA_BUFFER_SIZE 256             // parsed expression contains at most this many nodes
+#define FORMULA_MAX_DEPTH 256               // parentheses, negations and powers nest at most this deep
+#define OPTIMIZER_MAX_POWI 64               // x^n with an integer n up to this is computed by repeated squaring
+#define PARALLEL_SOLVE_THRESHOLD 1024       // graphs smaller than this are solved on one thread even with -j
+#define TILE_SHIFT 6
+#define TILE_SIZE (1 << TILE_SHIFT)         // cells are stored in TILE_SIZE x TILE_SIZE tiles
+#define TABLE_MAX_COLS 16384                // up to column XFD
+#define TABLE_MAX_ROWS (1 << 20)            // rows are numbered from 0 to TABLE_MAX_ROWS - 1
+#define COLUMN_NAME_SIZE 4                  // longest column name and its terminator
+#define CELL_NAME_SIZE 16                   // buffer for reading a cell reference from the user
+#define PARALLEL_IMPORT_THRESHOLD (1 << 20) // files smaller than this many bytes are imported on one thread even with -j
 
 #define ANSI_RESET              "\x1b[0m"
 #define ANSI_RED                "\x1b[31m"
@@ -4,37 +4,26 @@
 #include <aio.h>
 #include <assert.h>
 
-#define INVALID_ELEMENT {   \
-    .kind = ELEMENT_INV     \
-}
-
 #define PRINT_ELEMENT(element) {                                                    \
     if((element).kind == ELEMENT_NUM) printf("Element: %f\n", (element).as.number); \
     else printf("Element: %c\n", (element).as.operator);                            \
 }
 
-#define ELEMENT_STACK_SIZE 16
-#define STACK_INIT {        \
-    .elements = {0},        \
-    .count = 0              \
-}
-
-#define ELEMENT_QUEUE_SIZE 32
-#define QUEUE_INIT {        \
-    .elements = {0},        \
-    .first = 0,             \
-    .last = 0,              \
-    .count = 0              \
-}
-
 typedef union {
     double number;
     char operator;
+    struct {
+        int row;
+        int col;
+    } cell;             // referenced cell
+    int exponent;       // small integer power, evaluated by repeated squaring
 } ElementAs;
 
 typedef enum {
     ELEMENT_NUM = 0,
     ELEMENT_OP,
+    ELEMENT_REF,
+    ELEMENT_POWI,
     ELEMENT_INV
 } ElementKind;
 
@@ -43,23 +32,11 @@ typedef struct {
     ElementAs as;
 } Element;
 
+// compiled expression in reverse polish notation. unary minus is the '~' operator.
 typedef struct {
-    Element elements[ELEMENT_STACK_SIZE];
+    Element* elements;
     size_t count;
-} ElementStack;
-
-typedef struct {
-    Element elements[ELEMENT_QUEUE_SIZE];
-    size_t first;
-    size_t last;
-    size_t count;
-} ElementQueue;
-
-void    stack_push(ElementStack* stack, Element element);
-Element stack_pop(ElementStack* stack);
-
-void    queue_push(ElementQueue* queue, Element element);
-Element queue_pop(ElementQueue* queue);
+} Formula;
 
 
 
@@ -72,4 +49,4 @@ Element queue_pop(ElementQueue* queue);
 
 
 
-#endif //_ELEMENT_H
\ No newline at end of file
+#endif //_ELEMENT_H
@@ -6,16 +6,79 @@
 #include "table.h"
 #include "graph.h"
 
-bool stack_top_higher_precedence(ElementStack* stack, Element operator);
-char find_first_operator(StringStruct ss);
-double shunting_yard(StringStruct* sseq);
-double solve_equation_with_numbers(Table* table, Node* node);
+typedef enum {
+    TOKEN_END = 0,
+    TOKEN_NUMBER,
+    TOKEN_CELLREF,
+    TOKEN_OPERATOR,
+    TOKEN_LPAREN,
+    TOKEN_RPAREN,
+    TOKEN_INVALID
+} TokenKind;
+
+typedef struct {
+    TokenKind kind;
+    StringStruct text;
+    double number;
+    int row, col;       // for invalid tokens these hold the token_iscellref error code
+} Token;
+
+typedef enum {
+    AST_NUM = 0,
+    AST_REF,
+    AST_NEG,
+    AST_BINARY,
+    AST_POWI            // lhs raised to a small integer exponent, introduced by the optimizer
+} AstKind;
+
+typedef struct {
+    AstKind kind;
+    char operator;
+    double number;
+    int row, col;
+    int exponent;
+    int lhs, rhs;       // children, indices into the parser's node array
+} AstNode;
+
+typedef enum {
+    PARSE_OK = 0,
+    PARSE_EMPTY,
+    PARSE_DANGLING_OPERATOR,
+    PARSE_INVALID,
+    PARSE_OOB_COL,
+    PARSE_OOB_ROW,
+    PARSE_UNBALANCED,
+    PARSE_TOO_LONG
+} ParseStatus;
+
+// recursive descent parser over one expression, nodes live in the parser itself
+typedef struct {
+    Table* table;
+    StringStruct input;     // what is left to tokenize
+    Token token;            // current token
+    AstNode nodes[FORMULA_BUFFER_SIZE];
+    size_t count;
+    int depth;              // nesting of the rule being parsed, bounds the recursion
+    ParseStatus status;
+    StringStruct error_token;
+} Parser;
+
+void next_token(Parser* parser);
+int parse_formula(Parser* parser, StringStruct expr);
+int optimize_ast(Parser* parser, int index);
+Formula compile_ast(Parser* parser, int root, Arena* arena);
+double apply_operator(char operator, double lhs, double rhs);
+double integer_power(double base, int exponent);
+double evaluate_formula(Table* table, Formula* formula);
 double solve_expression(Table* table, Node* node);
-StringStruct d_find_and_replace(StringStruct _base, StringStruct _replace_this, double _with_this);
-double dfs_solve(Table* table, Node* root, VisitedNodes* visited);
-void solve_expressions(Table* table, Node* root);
+void solve_expressions(Table* table, Graph* graph);
+size_t mark_dirty(Graph* graph, Node* source, Node** cone);
+size_t recalculate_from(Table* table, Node* source);
+void unsolve_from(Table* table, Node* source);
+void recalculate_cell(Table* table, int row, int col);
+void invalidate_solve(Table* table);
 void solve_table(Table* table);
 
 
 
-#endif //_EQUATION_SOLVER_H
\ No newline at end of file
+#endif //_EQUATION_SOLVER_H
@@ -0,0 +1,12 @@
+#ifndef _FORMAT_H
+#define _FORMAT_H
+
+#include <stddef.h>
+
+#define FORMAT_BUFFER_SIZE 48   // enough for anything format_fixed and format_int write
+
+size_t format_fixed(double value, int precision, char* out);
+size_t format_int(long long value, char* out);
+
+
+#endif //_FORMAT_H
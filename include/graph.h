@@ -4,26 +4,41 @@
 #include <aio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <stdint.h>
 
+#include "arena.h"
 #include "constants.h"
+#include "element.h"
 #include "table.h"
 
 
-#define push_stack(stack, node) {           \
-    assert((stack)->count < NODE_LIST_SIZE);\
-    (stack)->nodes[(stack)->count++] = node;\
+#define push_stack(stack, node) {                                       \
+    if((stack)->count == (stack)->capacity) grow_recstack(stack);       \
+    (stack)->nodes[(stack)->count++] = node;                            \
+    mark_visited(node, &(stack)->members);                              \
 }
 
-#define pop_stack(stack) {                  \
-    assert((stack)->count > 0);             \
-    (stack)->count--;                       \
+#define pop_stack(stack) {                                              \
+    assert((stack)->count > 0);                                         \
+    unmark_visited((stack)->nodes[--(stack)->count], &(stack)->members);\
 }
 
 #define MKNode(_row, _col) {                \
     .row = _row,                            \
     .col = _col,                            \
+    .id = 0,                                \
     .count = 0,                             \
-    .dependencies = NULL                    \
+    .dependencies = NULL,                   \
+    .formula = {0},                         \
+    .index = -1,                            \
+    .lowlink = -1,                          \
+    .on_stack = false,                      \
+    .cyclic = false,                        \
+    .dependents = NULL,                     \
+    .dependent_count = 0,                   \
+    .pending = 0,                           \
+    .rank = 0,                              \
+    .dirty = false                          \
 }
 
 
@@ -31,29 +46,66 @@ struct Node;
 
 typedef struct Node {
     int row, col;
+    size_t id;          // position in the graph list, used to index visited sets
     struct Node** dependencies;
     size_t count;
+    Formula formula;    // empty unless the node is an expression cell
+    int index;          // tarjan bookkeeping, -1 until the node is visited
+    int lowlink;
+    bool on_stack;
+    bool cyclic;        // on a dependency cycle or depends on one, left out of the evaluation order and never solved
+    struct Node** dependents;   // nodes that depend on this one, filled in by build_dependents
+    size_t dependent_count;
+    size_t pending;     // dependencies not yet evaluated while scheduling
+    size_t rank;        // position in the evaluation order
+    bool dirty;         // needs to be evaluated again after a modification
 } Node;
 
 typedef struct {
-    Node* nodes[NODE_LIST_SIZE];
+    uint64_t* bits;     // one bit per graph node, indexed by its id
+} VisitedNodes;
+
+typedef struct {
+    Node** nodes;           // path currently being taken, used for reporting
     size_t count;
-} NodeList;
+    size_t capacity;
+    VisitedNodes members;   // same nodes as a bitset, used for membership checks
+    Arena* arena;
+} Recstack;
 
-typedef NodeList VisitedNodes;
-typedef NodeList Recstack;
+typedef struct Graph {
+    Node* root;
+    Node** slots;       // open addressing index of the nodes by cell, NULL slots are free
+    size_t slot_count;  // power of two, kept at least twice the node count
+    Node** list;        // every node in creation order, root excluded
+    size_t count;
+    size_t capacity;
+    Node** order;       // evaluation order, dependencies come before their dependents
+    size_t order_count;
+    int rows;
+    int cols;
+    Arena* arena;       // owns the nodes, their edges and formulas
+    Arena* scratch;     // temporaries that don't outlive a single pass over the graph
+} Graph;
 
-Node* make_root(int expression_count);
+Node* make_root(Arena* arena, int expression_count);
+Graph make_graph(Table* table);
+VisitedNodes make_visited(Arena* arena, size_t count);
 bool was_visited(Node* root, VisitedNodes* visited);
-Node* dfs(Node* root, Node* target, VisitedNodes* visited);
-Node* find_node(Node* root, Node* target);
-Node* alloc_new_node(Node* target);
-void add_node(Node* root, Node* source, Node* target);
-void handle_expression(Node* root, Node* values, size_t count);
-Node* perform_syntax_analysis(Table* table);
-bool dfs_cycle(Node* root, VisitedNodes* visited, Recstack* recstack);
-void report_cycle(Recstack* recstack);
-bool cycles_exist(Node* root);
+void mark_visited(Node* root, VisitedNodes* visited);
+void unmark_visited(Node* root, VisitedNodes* visited);
+Recstack make_recstack(Arena* arena, size_t count);
+void grow_recstack(Recstack* recstack);
+Node* lookup_node(Graph* graph, int row, int col);
+Node* find_node(Graph* graph, Node* target);
+Node* alloc_new_node(Graph* graph, Node* target);
+void add_node(Graph* graph, Node* source, Node* target);
+void handle_expression(Graph* graph, Node* values, size_t count);
+Graph perform_syntax_analysis(Table* table);
+void report_cycle(Node** members, size_t count);
+size_t find_cycles(Graph* graph);
+void build_dependents(Graph* graph);
+void schedule_graph(Graph* graph);
 
 
 #endif //_GRAPH_H
\ No newline at end of file
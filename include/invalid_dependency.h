@@ -2,9 +2,9 @@
 #define _INVALID_DEPENDENCY_H
 
 
-void report_invalid_dependency(Recstack* recstack, Cell* target_cell, const char* err_message);
-bool dfs_invalid_dependency(Table* table, Node* root, VisitedNodes* visited, Recstack* recstack);
-bool invalid_dependencies_exist(Table* table, Node* root);
+void report_invalid_dependency(Table* table, Recstack* recstack, const Cell* target_cell, const char* err_message);
+bool dfs_invalid_dependency(Table* table, Node* root, VisitedNodes* visited, Recstack* recstack, size_t* next);
+bool invalid_dependencies_exist(Table* table, Graph* graph);
 
 
 #endif //_INVALID_DEPENDENCY_H
\ No newline at end of file
@@ -5,8 +5,8 @@
 
 void print_menu_options();
 void free_table(Table* table);
-void handle_import(Table* table, char* loaded_content, bool* loaded_table);
-void handle_create(Table* table, char* loaded_content, bool* loaded_table);
+void handle_import(Table* table, bool* loaded_table);
+void handle_create(Table* table, bool* loaded_table);
 void handle_modify(Table* table, bool* loaded_table);
 void handle_export(Table* table, bool* loaded_table);
 void handle_solve(Table* table, bool* loaded_table);
@@ -0,0 +1,19 @@
+#ifndef _PARALLEL_IMPORT_H
+#define _PARALLEL_IMPORT_H
+
+#include <pthread.h>
+
+#include "table.h"
+
+typedef struct {
+    Table* table;
+    ImportChunk* chunk;
+} ImportWorker;
+
+void* index_worker(void* arg);
+void* populate_worker(void* arg);
+int split_input(StringStruct input, ImportChunk* chunks, int count);
+ImportStatus populate_table_parallel(Table* table, StringStruct input, int thread_count);
+
+
+#endif //_PARALLEL_IMPORT_H
@@ -0,0 +1,53 @@
+#ifndef _PARALLEL_SOLVER_H
+#define _PARALLEL_SOLVER_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#include "graph.h"
+#include "table.h"
+
+// per worker double ended queue. the owner pushes and pops at the bottom, thieves take from the top
+typedef struct {
+    Node** nodes;
+    size_t top;
+    size_t bottom;
+    pthread_mutex_t lock;
+} WorkQueue;
+
+struct Worker;
+
+// workers are started by the first parallel solve and kept for every solve after it, they sleep on the condition
+// variables whenever there is nothing for them to do
+typedef struct {
+    Table* table;
+    WorkQueue* queues;      // of the current solve
+    int worker_count;
+    size_t remaining;       // nodes not evaluated yet, updated atomically
+    size_t available;       // nodes queued but not taken yet, updated atomically
+    int sleeping;           // workers waiting for nodes to be queued, updated atomically
+    int busy;               // workers still inside the current solve
+    size_t generation;      // bumped for every solve, workers start on it when it changes
+    bool stopping;
+    pthread_mutex_t lock;   // guards busy, generation and stopping, and every wait below
+    pthread_cond_t start;   // a solve was handed out or the pool is stopping
+    pthread_cond_t ready;   // a node was queued or the last one was evaluated
+    pthread_cond_t done;    // every worker left the solve
+    pthread_t* threads;
+    struct Worker* workers;
+} WorkPool;
+
+typedef struct Worker {
+    WorkPool* pool;
+    int id;
+} Worker;
+
+void work_queue_push(WorkQueue* queue, Node* node);
+Node* work_queue_pop(WorkQueue* queue);
+Node* work_queue_steal(WorkQueue* queue);
+void* solve_worker(void* arg);
+void solve_expressions_parallel(Table* table, Graph* graph, int thread_count);
+void stop_solve_workers(void);
+
+
+#endif //_PARALLEL_SOLVER_H
@@ -19,6 +19,7 @@
 #include <aio.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef struct {
     const char* data;
@@ -194,9 +195,30 @@ char c_toupper(char character);
 
 /*
     Converts an SS to a double. Use with ss_isnumber() to ensure validity.
+    Numbers with up to 19 significant digits and 22 decimals are converted without copying the SS, anything longer goes through strtod.
 */
 double ss_tod(StringStruct ss);
 
+/*
+    Converts a decimal number that was already split into its digits, the fast path of ss_tod.
+
+    @param mantissa Every digit of the number, the period left out.
+    @param decimals How many of those digits come after the period.
+    @param negative Whether the number is negated.
+    @param out_number Converted number.
+    @return False if the conversion wouldn't be exact, the number then has to go through strtod.
+*/
+bool ss_exact_decimal(uint64_t mantissa, int decimals, bool negative, double* out_number);
+
+/*
+    Converts an SS made only of decimal digits to an int.
+
+    @param ss Input SS.
+    @param out_number Converted number.
+    @return False if the SS is empty, has something other than digits or doesn't fit in an int.
+*/
+bool ss_toi(StringStruct ss, int* out_number);
+
 /*
     Converts an SS to a float. Use with ss_isnumber() to ensure validity.
 */
@@ -269,6 +291,8 @@ char c_charat(StringStruct* ss, int index);
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <limits.h>
 
 size_t len(const char* string) {
 
@@ -604,14 +628,87 @@ char c_toupper(char character) {
     return character;
 }
 
+static const double _ss_powers_of_ten[] = {
+
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+bool ss_exact_decimal(uint64_t mantissa, int decimals, bool negative, double* out_number) {
+
+    //both the mantissa and the power of ten are exact doubles, so one division rounds correctly
+    if(mantissa > ((uint64_t)1 << 53) || decimals > 22) return false;
+
+    double number = (double)mantissa / _ss_powers_of_ten[decimals];
+    *out_number = negative ? -number : number;
+
+    return true;
+}
+
 double ss_tod(StringStruct ss) {
 
+    size_t i = 0;
+    bool negative = false;
+
+    if(i < ss.count && ss.data[i] == '-') {
+
+        negative = true;
+        i++;
+    }
+
+    uint64_t mantissa = 0;
+    bool any_digit = false;
+    int digits = 0;         // significant digits, leading zeros don't count
+    int decimals = 0;
+    bool period = false;
+
+    for(; i < ss.count; i++) {
+
+        char c = ss.data[i];
+
+        if(c == '.') {
+
+            period = true;
+            continue;
+        }
+
+        if(!c_isdigit(c) || digits == 19) break;
+
+        mantissa = mantissa * 10 + (uint64_t)(c - '0');
+        any_digit = true;
+        if(mantissa > 0) digits++;
+        if(period) decimals++;
+    }
+
+    if(!any_digit) return 0; //same as strtod, nothing to convert
+
+    double number;
+    if(i == ss.count && ss_exact_decimal(mantissa, decimals, negative, &number)) return number;
+
     char buffer[ss.count + 1];
-    strncpy(buffer, ss.data, ss.count);
+    memcpy(buffer, ss.data, ss.count);
     buffer[ss.count] = '\0';
 
     return strtod(buffer, NULL);
+}
+
+bool ss_toi(StringStruct ss, int* out_number) {
+
+    if(ss.count == 0) return false;
+
+    int number = 0;
 
+    for(size_t i = 0; i < ss.count; i++) {
+
+        char c = ss.data[i];
+        if(!c_isdigit(c)) return false;
+
+        if(number > (INT_MAX - (c - '0')) / 10) return false;
+        number = number * 10 + (c - '0');
+    }
+
+    *out_number = number;
+    return true;
 }
 
 float ss_tof(StringStruct ss) {
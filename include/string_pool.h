@@ -0,0 +1,34 @@
+#ifndef _STRING_POOL_H
+#define _STRING_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ss.h"
+
+#define STRING_POOL_INITIAL_SLOTS 64
+
+typedef struct {
+    uint32_t offset;
+    uint32_t length;
+} PoolEntry;
+
+// every distinct string is stored once, back to back in one buffer that is only ever appended to.
+// ids are indices into entries, so equal strings have equal ids
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+    PoolEntry* entries;
+    uint32_t count;
+    uint32_t entry_capacity;
+    uint32_t* slots;        // open addressing hash index, id + 1 or 0 for an empty slot
+    size_t slot_count;
+} StringPool;
+
+uint32_t pool_intern(StringPool* pool, const char* string, size_t length);
+StringStruct pool_string(StringPool* pool, uint32_t id);
+void pool_free(StringPool* pool);
+
+
+#endif //_STRING_POOL_H
@@ -0,0 +1,19 @@
+#ifndef _STRUCTURAL_H
+#define _STRUCTURAL_H
+
+#include <stddef.h>
+
+#define STRUCTURAL_INITIAL_SIZE 1024    // index starts with room for this many delimiters and grows as needed
+
+// positions of every row ('\n') and cell ('|') delimiter of the input, in order
+typedef struct {
+    size_t* offsets;
+    size_t count;
+    size_t capacity;
+} StructuralIndex;
+
+StructuralIndex build_structural_index(const char* data, size_t size);
+void free_structural_index(StructuralIndex* index);
+
+
+#endif //_STRUCTURAL_H
@@ -1,7 +1,14 @@
 #ifndef _TABLE_H
 #define _TABLE_H
 
+#include <stdint.h>
+
 #include "ss.h"
+#include "arena.h"
+#include "string_pool.h"
+#include "structural.h"
+#include "writer.h"
+#include "constants.h"
 
 typedef enum {
     EXPR_DEFAULT = 0,
@@ -9,11 +16,6 @@ typedef enum {
     EXPR_INVALID
 } ExprKind;
 
-typedef struct {
-    ExprKind kind;
-    StringStruct expr;
-} Expr;
-
 typedef enum {
     KIND_EMPTY = 0,
     KIND_TEXT,
@@ -22,35 +24,135 @@ typedef enum {
     KIND_COLOUR
 } CellKind;
 
-typedef union {
-    StringStruct text;
-    double number;
-    Expr expression;
-    StringStruct colour;
-} Cell_as;
-
+// a number cell holds its double as is. every other kind is a NaN whose payload carries the kind, the expression state
+// and a 32 bit index: the text's offset in the imported file or its id in the table's string pool. text cells are always
+// pooled, so two of them hold the same text exactly when their ids are equal. only imported formulas stay in the file
+// the box is kept xor'd with the empty cell's NaN, so zeroed memory reads as empty cells
 typedef struct {
-    CellKind kind;
-    Cell_as as;
+    uint64_t box;
+    uint32_t length;    // text and formula length
+    uint32_t width;     // what the cell last counted towards its column's width, see refresh_width
 } Cell;
 
+_Static_assert(sizeof(Cell) == 16, "Cells are meant to fit four to a cache line.");
+
+#define CELL_BOX_TAG        0x7FFC000000000000ull   // quiet NaN prefix of every boxed cell, parsed numbers never carry it
+#define CELL_KIND_SHIFT     45
+#define CELL_EXPR_SHIFT     43
+#define CELL_SOLVED_BIT     (1ull << 42)            // value is up to date with the formula and its dependencies
+#define CELL_POOLED_BIT     (1ull << 41)            // text is in the table's string pool rather than in the imported file
+
+static inline CellKind cell_kind(const Cell* cell) {
+
+    if(cell->box >> 48 != 0) return KIND_NUM;
+    return (CellKind)((cell->box >> CELL_KIND_SHIFT) & 7);
+}
+
+static inline double cell_number(const Cell* cell) {
+
+    union { uint64_t bits; double number; } raw = { .bits = cell->box ^ CELL_BOX_TAG };
+    return raw.number;
+}
+
+static inline uint32_t cell_index(const Cell* cell) {
+
+    return (uint32_t)cell->box;
+}
+
+static inline ExprKind cell_expr_kind(const Cell* cell) {
+
+    return (ExprKind)((cell->box >> CELL_EXPR_SHIFT) & 3);
+}
+
+static inline void set_expr_kind(Cell* cell, ExprKind kind) {
+
+    cell->box = (cell->box & ~(3ull << CELL_EXPR_SHIFT)) | ((uint64_t)kind << CELL_EXPR_SHIFT);
+}
+
+static inline bool cell_solved(const Cell* cell) {
+
+    return (cell->box & CELL_SOLVED_BIT) != 0;
+}
+
+static inline void set_solved(Cell* cell, bool solved) {
+
+    cell->box = solved ? cell->box | CELL_SOLVED_BIT : cell->box & ~CELL_SOLVED_BIT;
+}
+
+// square block of cells, allocated the first time one of them is written
+typedef struct {
+    Cell cells[TILE_SIZE * TILE_SIZE];      // row major
+    double numbers[TILE_SIZE * TILE_SIZE];  // column major copy of every number and solved expression value
+    uint64_t numeric[TILE_SIZE];            // per column, bit set for each row whose value is in numbers
+    int row;                                // top left cell of the tile
+    int col;
+} Tile;
+
+struct Graph;
+struct ColourRow;
+struct ColumnWidth;
+
 typedef struct {
-    Cell* cells;
+    Tile** tiles;           // tile_rows x tile_cols directory, NULL where every cell of the tile is empty
+    Tile** tile_list;       // allocated tiles in no particular order, for going over every non empty cell
+    size_t tile_count;
+    int tile_rows;          // directory capacity, grows while importing
+    int tile_cols;
     int rows;
     int cols;
+    int expression_count;   // upper bound on the formulas in the table, sizes the graph of a solve
+    struct ColumnWidth* widths; // per column, as many as the directory has room for
+    struct ColourRow** colour_blocks; // colour cells, kept as runs per row in blocks of TILE_SIZE rows instead of in tiles
+    char* mapping;          // imported file, text cells point into it. NULL for created tables
+    size_t mapping_size;
+    struct Graph* graph;    // graph and evaluation order of the last solve, NULL after a structural change
+    Arena arena;            // everything the graph points to, reset together with it
+    Arena scratch;          // temporaries of a single solve or recalculation
+    StringPool strings;     // text of cells changed through modify, each distinct string once
 } Table;
 
-char* consume_file(const char* input_file_path, int* count);
-void approx_table_size(StringStruct input, int* out_rows, int* out_cols);
+typedef enum {
+    IMPORT_OK = 0,
+    IMPORT_NOT_FOUND,
+    IMPORT_TOO_LARGE,   // cells index text by a 32 bit offset into the file
+    IMPORT_TOO_MANY_ROWS,
+    IMPORT_TOO_MANY_COLS
+} ImportStatus;
+
+// part of an imported file made of whole lines, along with what was found in it
+typedef struct {
+    StringStruct input;
+    StructuralIndex index;
+    int first_row;      // table row of the first line
+    int rows;
+    int cols;           // cells in the widest line
+    int expressions;
+    bool grow;          // rows and cols weren't counted up front, the table grows as the chunk is filled
+    StringPool strings; // text of the chunk's cells, moved into the table's pool by merge_chunks
+    ImportStatus status; // a growing chunk stops at the first line the table can't hold
+} ImportChunk;
+
+ImportStatus import_table(Table* table, const char* input_file_path);
 Table alloc_table(int rows, int cols);
-Cell* cell_at(Table* table, int row, int col);
-void calculate_new_cell_width(Table* table);
-void print_cell(Cell* cell, FILE* drain);
-void print_cell_kind(Cell* cell);
-void populate_table(Table* table, StringStruct input);
+void reserve_table(Table* table, int rows, int cols);
+Tile* tile_at(Table* table, int row, int col);
+const Cell* cell_at(Table* table, int row, int col);
+Cell* cell_put(Table* table, int row, int col);
+void free_tiles(Table* table);
+size_t number_width(double number);
+void render_number(double number, int width, Writer* writer);
+void render_cell(Table* table, int row, int col, int width, Writer* writer);
+void print_cell_kind(const Cell* cell);
+void index_chunk(ImportChunk* chunk);
+void populate_chunk(Table* table, ImportChunk* chunk);
+void merge_chunks(Table* table, ImportChunk* chunks, int count);
+ImportStatus populate_table(Table* table, StringStruct input);
+ImportStatus check_dimensions(int rows, int cols);
+char* column_name(int col, char* out);
 void print_table(Table* table, FILE* drain);
 void print_table_kind(Table* table);
 bool token_iscellref(Table* table, StringStruct token, int* out_row, int* out_column);
-bool is_colour(StringStruct token_copy, StringStruct* out_colour);
+CellKind fill_cell(Table* table, int row, int col, StringStruct token, StringPool* strings);
+StringStruct cell_text(Table* table, const Cell* cell);
 
 #endif //_TABLE_H
\ No newline at end of file
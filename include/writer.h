@@ -0,0 +1,50 @@
+#ifndef _WRITER_H
+#define _WRITER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#define WRITER_BLOCK_SIZE (64 * 1024)  // output is put together in memory and handed to the drain this much at a time
+
+// buffered output of a whole table
+typedef struct {
+    FILE* drain;
+    char* data;
+    size_t count;
+    size_t capacity;
+    bool ansi;              // escape codes only go to the terminal
+    int colour;             // ColourId the terminal is currently in, COLOUR_NONE (0) after a reset
+    char* glyphs;           // coloured cell as wide as the widest column, narrower ones use the start of it
+    size_t glyph_size;      // bytes per character of it
+} Writer;
+
+Writer make_writer(FILE* drain);
+char* writer_make_room(Writer* writer, size_t count);
+void writer_printf(Writer* writer, const char* format, ...);
+void writer_plain(Writer* writer);
+void writer_flush(Writer* writer);
+void free_writer(Writer* writer);
+
+// room for count more bytes at data + count. called for every piece of every cell, so the common case stays inline
+static inline char* writer_reserve(Writer* writer, size_t count) {
+
+    if(writer->count + count > writer->capacity) return writer_make_room(writer, count);
+    return writer->data + writer->count;
+}
+
+static inline void writer_append(Writer* writer, const char* data, size_t count) {
+
+    memcpy(writer_reserve(writer, count), data, count);
+    writer->count += count;
+}
+
+static inline void writer_fill(Writer* writer, char c, size_t count) {
+
+    memset(writer_reserve(writer, count), c, count);
+    writer->count += count;
+}
+
+
+#endif //_WRITER_H
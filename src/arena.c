@@ -0,0 +1,84 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "arena.h"
+
+static ArenaBlock* alloc_block(size_t capacity) {
+
+    ArenaBlock* block = malloc(sizeof(ArenaBlock) + capacity);
+    assert(block != NULL);
+
+    block->next = NULL;
+    block->used = 0;
+    block->capacity = capacity;
+
+    return block;
+}
+
+void* arena_alloc(Arena* arena, size_t size) {
+
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    if(size == 0) size = ARENA_ALIGNMENT;
+
+    if(arena->current == NULL) {
+
+        arena->first = arena->current = alloc_block(size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE);
+    }
+
+    //blocks kept from before the last reset are reused first
+    while(arena->current->used + size > arena->current->capacity) {
+
+        if(arena->current->next == NULL) {
+
+            arena->current->next = alloc_block(size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE);
+        }
+
+        arena->current = arena->current->next;
+    }
+
+    void* memory = arena->current->data + arena->current->used;
+    arena->current->used += size;
+
+    return memory;
+}
+
+void* arena_calloc(Arena* arena, size_t count, size_t size) {
+
+    void* memory = arena_alloc(arena, count * size);
+    memset(memory, 0, count * size);
+
+    return memory;
+}
+
+// arenas can't resize in place, the old memory stays in the arena until the next reset
+void* arena_grow(Arena* arena, void* old, size_t old_size, size_t new_size) {
+
+    void* memory = arena_alloc(arena, new_size);
+    if(old != NULL) memcpy(memory, old, old_size < new_size ? old_size : new_size);
+
+    return memory;
+}
+
+// keeps the blocks so the next round of allocations doesn't go through malloc again
+void arena_reset(Arena* arena) {
+
+    for(ArenaBlock* block = arena->first; block != NULL; block = block->next) block->used = 0;
+
+    arena->current = arena->first;
+}
+
+void arena_free(Arena* arena) {
+
+    ArenaBlock* block = arena->first;
+
+    while(block != NULL) {
+
+        ArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+
+    arena->first = NULL;
+    arena->current = NULL;
+}
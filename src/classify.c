@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "classify.h"
+#include "constants.h"
+
+typedef enum {
+    CHAR_OTHER = 0,
+    CHAR_DIGIT,
+    CHAR_MINUS,
+    CHAR_PERIOD,
+    CHAR_CLASS_COUNT
+} CharClass;
+
+// states of the number recognizer, same rules as ss_isnumber: a digit or '-' first, then digits and at most one '.'
+typedef enum {
+    NUMBER_START = 0,
+    NUMBER_SIGN,
+    NUMBER_INTEGER,
+    NUMBER_FRACTION,
+    NUMBER_REJECT,
+    NUMBER_STATE_COUNT
+} NumberState;
+
+static const uint8_t char_classes[256] = {
+
+    ['0'] = CHAR_DIGIT, ['1'] = CHAR_DIGIT, ['2'] = CHAR_DIGIT, ['3'] = CHAR_DIGIT, ['4'] = CHAR_DIGIT,
+    ['5'] = CHAR_DIGIT, ['6'] = CHAR_DIGIT, ['7'] = CHAR_DIGIT, ['8'] = CHAR_DIGIT, ['9'] = CHAR_DIGIT,
+    ['-'] = CHAR_MINUS,
+    ['.'] = CHAR_PERIOD
+};
+
+static const uint8_t number_transitions[NUMBER_STATE_COUNT][CHAR_CLASS_COUNT] = {
+
+    //                      other           digit            minus           period
+    [NUMBER_START]    = { NUMBER_REJECT, NUMBER_INTEGER,  NUMBER_SIGN,   NUMBER_REJECT   },
+    [NUMBER_SIGN]     = { NUMBER_REJECT, NUMBER_INTEGER,  NUMBER_REJECT, NUMBER_FRACTION },
+    [NUMBER_INTEGER]  = { NUMBER_REJECT, NUMBER_INTEGER,  NUMBER_REJECT, NUMBER_FRACTION },
+    [NUMBER_FRACTION] = { NUMBER_REJECT, NUMBER_FRACTION, NUMBER_REJECT, NUMBER_REJECT   },
+    [NUMBER_REJECT]   = { NUMBER_REJECT, NUMBER_REJECT,   NUMBER_REJECT, NUMBER_REJECT   }
+};
+
+static const struct {
+    const char* name;
+    size_t length;
+    const char* code;
+} colours[COLOUR_COUNT] = {
+
+    [COLOUR_NONE]    = { "",        0, "" },
+    [COLOUR_RED]     = { "RED",     3, ANSI_RED },
+    [COLOUR_GREEN]   = { "GREEN",   5, ANSI_GREEN },
+    [COLOUR_YELLOW]  = { "YELLOW",  6, ANSI_YELLOW },
+    [COLOUR_BLUE]    = { "BLUE",    4, ANSI_BLUE },
+    [COLOUR_MAGENTA] = { "MAGENTA", 7, ANSI_MAGENTA },
+    [COLOUR_CYAN]    = { "CYAN",    4, ANSI_CYAN },
+    [COLOUR_BLACK]   = { "BLACK",   5, ANSI_BLACK },
+    [COLOUR_WHITE]   = { "WHITE",   5, ANSI_WHITE }
+};
+
+// names are told apart by their first letter and length, only BLUE and BLACK share a letter
+static ColourId find_colour(const char* name, size_t length) {
+
+    ColourId candidate = COLOUR_NONE;
+
+    switch(length > 0 ? name[0] : '\0') {
+
+        case 'R': candidate = COLOUR_RED; break;
+        case 'G': candidate = COLOUR_GREEN; break;
+        case 'Y': candidate = COLOUR_YELLOW; break;
+        case 'B': candidate = length == 4 ? COLOUR_BLUE : COLOUR_BLACK; break;
+        case 'M': candidate = COLOUR_MAGENTA; break;
+        case 'C': candidate = COLOUR_CYAN; break;
+        case 'W': candidate = COLOUR_WHITE; break;
+        default: return COLOUR_NONE;
+    }
+
+    if(colours[candidate].length != length || memcmp(colours[candidate].name, name, length) != 0) return COLOUR_NONE;
+
+    return candidate;
+}
+
+// settles the kind of a cell in one pass over the token. numbers are converted while they're recognized
+TokenClass classify_token(StringStruct token) {
+
+    TokenClass class = {0};
+
+    if(token.count == 0) {
+
+        class.kind = KIND_EMPTY;
+        return class;
+    }
+
+    switch(token.data[0]) {
+
+        case '=': {
+
+            class.kind = KIND_EXPR;
+            return class;
+        }
+
+        case '#': {
+
+            class.colour = find_colour(token.data + 1, token.count - 1);
+            class.kind = class.colour != COLOUR_NONE ? KIND_COLOUR : KIND_TEXT;
+            return class;
+        }
+
+        default: break;
+    }
+
+    NumberState state = NUMBER_START;
+    uint64_t mantissa = 0;
+    bool any_digit = false;
+    int digits = 0;
+    int decimals = 0;
+
+    for(size_t i = 0; i < token.count && state != NUMBER_REJECT; i++) {
+
+        uint8_t char_class = char_classes[(unsigned char)token.data[i]];
+        state = number_transitions[state][char_class];
+        any_digit |= char_class == CHAR_DIGIT;
+
+        if(char_class == CHAR_DIGIT && digits < 19) {
+
+            mantissa = mantissa * 10 + (uint64_t)(token.data[i] - '0');
+            if(mantissa > 0) digits++;
+            if(state == NUMBER_FRACTION) decimals++;
+        }
+        else if(char_class == CHAR_DIGIT) {
+
+            digits++; //too long for the fast path, counted only so it gets skipped
+        }
+    }
+
+    if(state == NUMBER_REJECT) {
+
+        class.kind = KIND_TEXT;
+        return class;
+    }
+
+    class.kind = KIND_NUM;
+
+    //the digits are already in the mantissa, so only what ss_exact_decimal can't do exactly goes through ss_tod.
+    //a lone '-' is 0, like strtod
+    bool negative = token.data[0] == '-' && any_digit;
+
+    if(digits > 19 || !ss_exact_decimal(mantissa, decimals, negative, &class.number)) class.number = ss_tod(token);
+
+    return class;
+}
+
+StringStruct colour_code(ColourId colour) {
+
+    return ss_form_string_nt(colours[colour].code);
+}
@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "colour_layer.h"
+#include "table.h"
+#include "classify.h"
+#include "constants.h"
+
+
+// rows with runs, NULL when none of the TILE_SIZE rows of its block ever had a colour
+ColourRow* colour_row(Table* table, int row) {
+
+    if(table->colour_blocks == NULL) return NULL;
+
+    ColourRow* block = table->colour_blocks[row >> TILE_SHIFT];
+    if(block == NULL) return NULL;
+
+    return &block[row & (TILE_SIZE - 1)];
+}
+
+// index of the first run that ends after col
+static int find_run(ColourRow* line, int col) {
+
+    int low = 0;
+    int high = line->count;
+
+    while(low < high) {
+
+        int middle = (low + high) / 2;
+
+        if((int)(line->runs[middle].col + line->runs[middle].length) <= col) low = middle + 1;
+        else high = middle;
+    }
+
+    return low;
+}
+
+ColourId colour_at(Table* table, int row, int col) {
+
+    ColourRow* line = colour_row(table, row);
+    if(line == NULL || line->count == 0) return COLOUR_NONE;
+
+    int run = find_run(line, col);
+    if(run == line->count || (int)line->runs[run].col > col) return COLOUR_NONE;
+
+    return (ColourId)(line->runs[run].colour + 1);
+}
+
+// replaces remove runs starting at at with count new ones
+static void splice_runs(ColourRow* line, int at, int remove, ColourRun* runs, int count) {
+
+    int new_count = line->count - remove + count;
+
+    if(new_count > line->capacity) {
+
+        line->capacity = line->capacity > 0 ? line->capacity * 2 : 4;
+        if(line->capacity < new_count) line->capacity = new_count;
+
+        line->runs = realloc(line->runs, sizeof(ColourRun) * line->capacity);
+        assert(line->runs != NULL);
+    }
+
+    memmove(&line->runs[at + count], &line->runs[at + remove], sizeof(ColourRun) * (line->count - at - remove));
+    if(count > 0) memcpy(&line->runs[at], runs, sizeof(ColourRun) * count);
+
+    line->count = new_count;
+}
+
+// merges touching runs of the same colour between first and last
+static void merge_runs(ColourRow* line, int first, int last) {
+
+    if(first < 0) first = 0;
+
+    for(int i = first; i < last && i + 1 < line->count; ) {
+
+        ColourRun* run = &line->runs[i];
+        ColourRun* next = &line->runs[i + 1];
+
+        if(run->col + run->length == next->col && run->colour == next->colour) {
+
+            run->length += next->length;
+            splice_runs(line, i + 1, 1, NULL, 0);
+            last--;
+        }
+        else {
+
+            i++;
+        }
+    }
+}
+
+// colours a single cell, COLOUR_NONE takes its colour away. rows are only ever changed by whoever fills that row
+void set_colour(Table* table, int row, int col, ColourId colour) {
+
+    ColourRow** slot = &table->colour_blocks[row >> TILE_SHIFT];
+    ColourRow* block = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+
+    if(block == NULL) {
+
+        if(colour == COLOUR_NONE) return;
+
+        ColourRow* fresh = calloc(TILE_SIZE, sizeof(ColourRow));
+        assert(fresh != NULL);
+
+        //chunks of a parallel import can share a block of rows, same as they share tiles
+        if(__atomic_compare_exchange_n(slot, &block, fresh, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) block = fresh;
+        else free(fresh);
+    }
+
+    ColourRow* line = &block[row & (TILE_SIZE - 1)];
+    int at = find_run(line, col);
+
+    ColourRun pieces[3];
+    int count = 0;
+    int remove = 0;
+
+    if(at < line->count && (int)line->runs[at].col <= col) { //split the run the cell is in
+
+        ColourRun run = line->runs[at];
+        if(colour != COLOUR_NONE && run.colour == colour - 1) return;
+
+        remove = 1;
+
+        if((int)run.col < col) pieces[count++] = (ColourRun){ .col = run.col, .length = col - run.col, .colour = run.colour };
+        if(colour != COLOUR_NONE) pieces[count++] = (ColourRun){ .col = col, .length = 1, .colour = colour - 1 };
+        if((int)(run.col + run.length) > col + 1) pieces[count++] = (ColourRun){ .col = col + 1, .length = run.col + run.length - col - 1, .colour = run.colour };
+    }
+    else {
+
+        if(colour == COLOUR_NONE) return;
+
+        pieces[count++] = (ColourRun){ .col = col, .length = 1, .colour = colour - 1 };
+    }
+
+    splice_runs(line, at, remove, pieces, count);
+    merge_runs(line, at - 1, at + count);
+}
+
+// enough of the glyph to fill the widest column. a full block character on the terminal, '#' anywhere else
+void build_glyphs(Writer* writer, int width) {
+
+    writer->glyph_size = writer->ansi ? sizeof("\u2588") - 1 : 1;
+    writer->glyphs = malloc(width * writer->glyph_size);
+    assert(writer->glyphs != NULL);
+
+    for(int i = 0; i < width; i++) memcpy(writer->glyphs + i * writer->glyph_size, writer->ansi ? "\u2588" : "#", writer->glyph_size);
+}
+
+// count cells of the same colour next to each other, widths holds the width of each of their columns. the escape code is only written when the colour changes,
+// so neighbouring runs of different colours don't need a reset in between either
+void render_colour_run(Writer* writer, ColourId colour, const int* widths, int count) {
+
+    if(writer->ansi && writer->colour != (int)colour) {
+
+        StringStruct code = colour_code(colour);
+
+        writer_append(writer, code.data, code.count);
+        writer->colour = colour;
+    }
+
+    for(int i = 0; i < count; i++) {
+
+        writer_append(writer, writer->glyphs, widths[i] * writer->glyph_size);
+        writer_append(writer, "|", 1);
+    }
+}
+
+// one block of rows per tile row, grows with the tile directory
+void reserve_colours(Table* table, int tile_rows) {
+
+    ColourRow** blocks = realloc(table->colour_blocks, sizeof(ColourRow*) * (tile_rows > 0 ? tile_rows : 1));
+    assert(blocks != NULL);
+
+    for(int i = table->tile_rows; i < tile_rows; i++) blocks[i] = NULL;
+
+    table->colour_blocks = blocks;
+}
+
+void free_colours(Table* table) {
+
+    if(table->colour_blocks == NULL) return;
+
+    for(int i = 0; i < table->tile_rows; i++) {
+
+        if(table->colour_blocks[i] == NULL) continue;
+
+        for(int row = 0; row < TILE_SIZE; row++) free(table->colour_blocks[i][row].runs);
+        free(table->colour_blocks[i]);
+    }
+
+    free(table->colour_blocks);
+    table->colour_blocks = NULL;
+}
@@ -0,0 +1,280 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "columns.h"
+#include "table.h"
+
+#define TILE_ROW(row) ((row) & (TILE_SIZE - 1))
+#define TILE_COL(col) ((col) & (TILE_SIZE - 1))
+
+// records the value of a number cell or solved expression in its tile's column. the cell itself has to exist already
+void store_value(Table* table, int row, int col, double value) {
+
+    Tile* tile = tile_at(table, row, col);
+    assert(tile != NULL);
+
+    tile->numbers[TILE_COL(col) * TILE_SIZE + TILE_ROW(row)] = value;
+
+    //parallel solves set bits of the same column at the same time
+    __atomic_fetch_or(&tile->numeric[TILE_COL(col)], (uint64_t)1 << TILE_ROW(row), __ATOMIC_RELAXED);
+}
+
+void clear_value(Table* table, int row, int col) {
+
+    Tile* tile = tile_at(table, row, col);
+    if(tile == NULL) return;
+
+    __atomic_fetch_and(&tile->numeric[TILE_COL(col)], ~((uint64_t)1 << TILE_ROW(row)), __ATOMIC_RELAXED);
+}
+
+// value of a number cell or solved expression straight from its column, without looking at the cell
+double value_at(Table* table, int row, int col) {
+
+    Tile* tile = tile_at(table, row, col);
+    assert(tile != NULL && (__atomic_load_n(&tile->numeric[TILE_COL(col)], __ATOMIC_RELAXED) >> TILE_ROW(row)) & 1);
+
+    return tile->numbers[TILE_COL(col) * TILE_SIZE + TILE_ROW(row)];
+}
+
+#if defined(__SSE2__)
+
+// lanes that are all ones for set bits of a two bit mask
+static __m128d lane_mask(unsigned bits) {
+
+    return _mm_castsi128_pd(_mm_set_epi64x(bits & 2 ? -1 : 0, bits & 1 ? -1 : 0));
+}
+
+// number_width only depends on the sign, whether there is a fractional part and how large the integral part is.
+// the widest value of a column is therefore among the largest magnitudes of each sign and kind, so only those get formatted
+size_t column_width(Tile* tile, int col) {
+
+    uint64_t numeric = tile->numeric[col];
+    if(numeric == 0) return 0;
+
+    const double* numbers = &tile->numbers[col * TILE_SIZE];
+    const __m128d sign_bit = _mm_set1_pd(-0.0);
+    const __m128d infinity = _mm_set1_pd(INFINITY);
+
+    __m128d largest[2][2];      // [negative][fractional] largest magnitude
+    __m128d present[2][2];
+    size_t width = 0;
+
+    for(int negative = 0; negative < 2; negative++) {
+
+        for(int fractional = 0; fractional < 2; fractional++) {
+
+            largest[negative][fractional] = _mm_setzero_pd();
+            present[negative][fractional] = _mm_setzero_pd();
+        }
+    }
+
+    for(int row = 0; row < TILE_SIZE; row += 2) {
+
+        unsigned bits = (numeric >> row) & 3;
+        if(bits == 0) continue;
+
+        __m128d values = _mm_loadu_pd(numbers + row);
+        __m128d lanes = lane_mask(bits);
+        __m128d magnitude = _mm_andnot_pd(sign_bit, values);
+        __m128d finite = _mm_cmplt_pd(magnitude, infinity);
+
+        //same test as number_width, truncating conversion gives INT_MIN when out of range just like the (int) cast
+        __m128d truncated = _mm_cvtepi32_pd(_mm_cvttpd_epi32(values));
+        __m128d fraction = _mm_cmpneq_pd(values, truncated);
+
+        //sign of each lane spread over the whole lane, so -0.0 counts as negative like it does for printf
+        __m128i signs = _mm_srai_epi32(_mm_castpd_si128(values), 31);
+        __m128d negative = _mm_castsi128_pd(_mm_shuffle_epi32(signs, _MM_SHUFFLE(3, 3, 1, 1)));
+
+        __m128d classes[2][2] = {
+
+            { _mm_andnot_pd(negative, _mm_andnot_pd(fraction, finite)), _mm_andnot_pd(negative, _mm_and_pd(fraction, finite)) },
+            { _mm_and_pd(negative, _mm_andnot_pd(fraction, finite)),    _mm_and_pd(negative, _mm_and_pd(fraction, finite)) }
+        };
+
+        for(int n = 0; n < 2; n++) {
+
+            for(int f = 0; f < 2; f++) {
+
+                __m128d members = _mm_and_pd(classes[n][f], lanes);
+
+                largest[n][f] = _mm_max_pd(largest[n][f], _mm_and_pd(members, magnitude));
+                present[n][f] = _mm_or_pd(present[n][f], members);
+            }
+        }
+
+        //inf and nan are rare enough to go through number_width one by one
+        int special = _mm_movemask_pd(_mm_andnot_pd(finite, lanes));
+
+        for(int lane = 0; lane < 2; lane++) {
+
+            if(!(special & (1 << lane))) continue;
+
+            size_t length = number_width(numbers[row + lane]);
+            if(length > width) width = length;
+        }
+    }
+
+    for(int n = 0; n < 2; n++) {
+
+        for(int f = 0; f < 2; f++) {
+
+            if(_mm_movemask_pd(present[n][f]) == 0) continue;
+
+            double pair[2];
+            _mm_storeu_pd(pair, largest[n][f]);
+
+            double magnitude = pair[0] > pair[1] ? pair[0] : pair[1];
+            size_t length = number_width(n ? -magnitude : magnitude);
+            if(length > width) width = length;
+        }
+    }
+
+    return width;
+}
+
+#else
+
+size_t column_width(Tile* tile, int col) {
+
+    uint64_t numeric = tile->numeric[col];
+    size_t width = 0;
+
+    for(int row = 0; numeric != 0; row++, numeric >>= 1) {
+
+        if(!(numeric & 1)) continue;
+
+        size_t length = number_width(tile->numbers[col * TILE_SIZE + row]);
+        if(length > width) width = length;
+    }
+
+    return width;
+}
+
+#endif
+
+// width the cell is printed at without padding. coloured cells don't take up any, the layer draws them at whatever width
+// the column ends up with
+uint32_t cell_width(Table* table, const Cell* cell, int row, int col) {
+
+    switch(cell_kind(cell)) {
+
+        case KIND_NUM: return number_width(cell_number(cell));
+        case KIND_TEXT: return cell->length;
+        case KIND_EXPR: return cell_solved(cell) ? number_width(value_at(table, row, col)) : cell->length;
+        default: return 0;
+    }
+}
+
+static void add_width(ColumnWidth* column, uint32_t width) {
+
+    if(column->stale || width == 0) return; //a stale column is measured again anyway
+
+    if(width > column->widest) {
+
+        column->widest = width;
+        column->count = 1;
+    }
+    else if(width == column->widest && column->count > 0) {
+
+        column->count++;
+    }
+}
+
+static void remove_width(ColumnWidth* column, uint32_t width) {
+
+    if(column->stale || width == 0 || width != column->widest) return;
+
+    //the last of the widest cells got narrower, nothing says how wide the next widest is until the column is looked at
+    if(column->count <= 1) column->stale = true;
+    else column->count--;
+}
+
+// brings the column of the cell up to date after its content or value changed. nothing to do for cells of tiles that
+// don't exist, they are all empty and were never counted
+void refresh_width(Table* table, int row, int col) {
+
+    Tile* tile = tile_at(table, row, col);
+    if(tile == NULL) return;
+
+    Cell* cell = &tile->cells[TILE_ROW(row) * TILE_SIZE + TILE_COL(col)];
+    uint32_t width = cell_width(table, cell, row, col);
+
+    if(width == cell->width) return;
+
+    ColumnWidth* column = &table->widths[col];
+
+    remove_width(column, cell->width);
+    cell->width = width;
+    add_width(column, width);
+}
+
+// builds every column's widths from the ones the import left in the cells
+void count_widths(Table* table) {
+
+    memset(table->widths, 0, sizeof(ColumnWidth) * table->tile_cols * TILE_SIZE);
+
+    for(size_t i = 0; i < table->tile_count; i++) {
+
+        Tile* tile = table->tile_list[i];
+
+        for(int col = 0; col < TILE_SIZE; col++) {
+
+            ColumnWidth* column = &table->widths[tile->col + col];
+            for(int row = 0; row < TILE_SIZE; row++) add_width(column, tile->cells[row * TILE_SIZE + col].width);
+        }
+    }
+}
+
+// widest cell of the column. only a column whose widest cell shrank is gone over again, and only its own tiles.
+// numbers and solved expressions are measured from the value columns, the rest from what their cells last counted.
+// how many cells share the widest width isn't known afterwards, the next of them to shrink makes the column stale again
+uint32_t widest_in_column(Table* table, int col) {
+
+    ColumnWidth* column = &table->widths[col];
+    if(!column->stale) return column->widest;
+
+    uint32_t widest = 0;
+
+    for(int tile_row = 0; tile_row < table->tile_rows; tile_row++) {
+
+        Tile* tile = table->tiles[(size_t)tile_row * table->tile_cols + (col >> TILE_SHIFT)];
+        if(tile == NULL) continue;
+
+        uint32_t numbers = (uint32_t)column_width(tile, TILE_COL(col));
+        if(numbers > widest) widest = numbers;
+
+        uint64_t numeric = tile->numeric[TILE_COL(col)];
+
+        for(int row = 0; row < TILE_SIZE; row++) {
+
+            if((numeric >> row) & 1) continue;
+
+            uint32_t width = tile->cells[row * TILE_SIZE + TILE_COL(col)].width;
+            if(width > widest) widest = width;
+        }
+    }
+
+    *column = (ColumnWidth){ .widest = widest };
+    return widest;
+}
+
+// one entry per column the tile directory has room for, new ones start out empty
+void reserve_widths(Table* table, int tile_cols) {
+
+    ColumnWidth* widths = realloc(table->widths, sizeof(ColumnWidth) * (tile_cols > 0 ? tile_cols * TILE_SIZE : 1));
+    assert(widths != NULL);
+
+    size_t used = (size_t)table->tile_cols * TILE_SIZE;
+    memset(widths + used, 0, sizeof(ColumnWidth) * ((size_t)tile_cols * TILE_SIZE - used));
+
+    table->widths = widths;
+}
@@ -2,244 +2,575 @@
 #include <assert.h>
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "equation_solver.h"
 #include "element.h"
 #include "ss.h"
 #include "table.h"
+#include "columns.h"
 #include "graph.h"
 #include "invalid_dependency.h"
+#include "parallel_solver.h"
 
-bool stack_top_higher_precedence(ElementStack* stack, Element operator) {
+int solve_thread_count = 1; //set with -j, more than one evaluates independent cells in parallel
 
-    if(stack->count == 0) return false;
+static bool is_word_char(char c) {
 
-    Element op = stack->elements[stack->count - 1];
+    return c_isalnum(c) || c == '.';
+}
+
+// single pass tokenizer, cuts the next token off the front of the parser input
+void next_token(Parser* parser) {
+
+    parser->input = ss_trim_left(parser->input);
+
+    Token token = {0};
+
+    if(parser->input.count == 0) {
+
+        token.kind = TOKEN_END;
+        parser->token = token;
+        return;
+    }
+
+    char c = c_charat(&parser->input, 0);
+
+    if(c_isoperator(c)) {
+
+        token.kind = TOKEN_OPERATOR;
+        token.text = ss_cut_n(&parser->input, 1);
+    }
+    else if(c == '(') {
+
+        token.kind = TOKEN_LPAREN;
+        token.text = ss_cut_n(&parser->input, 1);
+    }
+    else if(c == ')') {
+
+        token.kind = TOKEN_RPAREN;
+        token.text = ss_cut_n(&parser->input, 1);
+    }
+    else if(is_word_char(c)) {
 
-    if(operator.as.operator == '+' || operator.as.operator == '-') {
+        size_t length = 0;
+        while(length < parser->input.count && is_word_char(parser->input.data[length])) length++;
 
-        if(op.as.operator == '+' || op.as.operator == '-') return false;
-        else return true;
+        token.text = ss_cut_n(&parser->input, length);
+
+        if(ss_isnumber(token.text)) {
+
+            token.kind = TOKEN_NUMBER;
+            token.number = ss_tod(token.text);
+        }
+        else if(token_iscellref(parser->table, token.text, &token.row, &token.col)) {
+
+            token.kind = TOKEN_CELLREF;
+        }
+        else {
+
+            token.kind = TOKEN_INVALID; //row and col say why, see token_iscellref
+        }
     }
-    else if(operator.as.operator == '*' || operator.as.operator == '/') {
+    else {
 
-        if(op.as.operator == '^') return true;
-        else return false;
+        token.kind = TOKEN_INVALID;
+        token.text = ss_cut_n(&parser->input, 1);
+        token.row = -1;
+        token.col = -1;
     }
-    else return false;
+
+    parser->token = token;
 }
 
-char find_first_operator(StringStruct ss) {
+static int parse_error(Parser* parser, ParseStatus status) {
 
-    for(int i = 0; i < ss.count; i++) {
+    if(parser->status == PARSE_OK) {
 
-        if(!c_isoperator(c_charat(&ss, i))) continue;
-        return c_charat(&ss, i);
+        parser->status = status;
+        parser->error_token = parser->token.text;
     }
 
-    return '\0';
+    return -1;
 }
 
-double shunting_yard(StringStruct* sseq) {
+static int ast_push(Parser* parser, AstNode node) {
+
+    if(parser->count == FORMULA_BUFFER_SIZE) return parse_error(parser, PARSE_TOO_LONG);
 
-    ElementStack stack = STACK_INIT;
-    ElementQueue queue = QUEUE_INIT;
+    parser->nodes[parser->count] = node;
+    return (int)parser->count++;
+}
 
-    while(sseq->count > 0) {
+static int ast_binary(Parser* parser, char operator, int lhs, int rhs) {
 
-        bool negative = false;
-        if(c_charat(sseq, 0) == '-') {
+    if(lhs < 0 || rhs < 0) return -1;
 
-            negative = true;
-            ss_cut_n(sseq, 1);
-            *sseq = ss_trim(*sseq);
-        }
+    AstNode node = {
+
+        .kind = AST_BINARY,
+        .operator = operator,
+        .lhs = lhs,
+        .rhs = rhs
+    };
+
+    return ast_push(parser, node);
+}
+
+static int parse_sum(Parser* parser);
 
-        if(find_first_operator(*sseq) != '\0') { //postoji operator
+// every rule that can nest goes through here, formulas come from files and could otherwise exhaust the stack
+static bool enter_rule(Parser* parser) {
 
-            StringStruct number = ss_trim(ss_cut_to_delim(sseq, find_first_operator(*sseq)));
-            
-            Element num = {
+    if(parser->depth == FORMULA_MAX_DEPTH) {
 
-                .kind = ELEMENT_NUM,
-                .as.number = ss_tod(number)
+        parse_error(parser, PARSE_TOO_LONG);
+        return false;
+    }
+
+    parser->depth++;
+    return true;
+}
+
+// primary := number | cellref | '(' sum ')'
+static int parse_primary(Parser* parser) {
+
+    Token token = parser->token;
+
+    switch(token.kind) {
+
+        case TOKEN_NUMBER: {
+
+            next_token(parser);
+
+            AstNode node = {
+
+                .kind = AST_NUM,
+                .number = token.number
             };
 
-            if(negative) num.as.number *= -1;
+            return ast_push(parser, node);
+        }
+
+        case TOKEN_CELLREF: {
 
-            queue_push(&queue, num); //enqueue the number
+            next_token(parser);
 
-            Element operator = {
+            AstNode node = {
 
-                .kind = ELEMENT_OP,
-                .as.operator = c_charat(sseq, 0)
+                .kind = AST_REF,
+                .row = token.row,
+                .col = token.col
             };
 
-            ss_cut_n(sseq, 1);
-            *sseq = ss_trim(*sseq);
+            return ast_push(parser, node);
+        }
 
-            while(stack.count > 0 && stack_top_higher_precedence(&stack, operator)) {
+        case TOKEN_LPAREN: {
 
-                Element popped_operator = stack_pop(&stack);
-                queue_push(&queue, popped_operator);
-            }
+            if(!enter_rule(parser)) return -1;
+
+            next_token(parser);
+            int inner = parse_sum(parser);
+            parser->depth--;
+            if(inner < 0) return -1;
+
+            if(parser->token.kind != TOKEN_RPAREN) return parse_error(parser, PARSE_UNBALANCED);
 
-            stack_push(&stack, operator);
+            next_token(parser);
+            return inner;
         }
-        else {
 
-            StringStruct number = ss_trim(ss_cut_n(sseq, sseq->count + 1));
+        case TOKEN_END: {
+
+            return parse_error(parser, PARSE_DANGLING_OPERATOR);
+        }
 
-            Element num = {
+        case TOKEN_INVALID: {
 
-                .kind = ELEMENT_NUM,
-                .as.number = ss_tod(number)
-            };
+            if(token.row == -2) return parse_error(parser, PARSE_OOB_COL);
+            if(token.row == -3) return parse_error(parser, PARSE_OOB_ROW);
 
-            if(negative) num.as.number *= -1;
+            return parse_error(parser, PARSE_INVALID);
+        }
+
+        default: {
 
-            queue_push(&queue, num); //enqueue the number
+            return parse_error(parser, PARSE_INVALID);
         }
     }
+}
 
-    while(stack.count > 0) {
+// unary := '-' unary | primary. binds tighter than '^', so -2^2 is 4 and 2^-2 is 0.25
+static int parse_unary(Parser* parser) {
 
-        Element popped = stack_pop(&stack);
-        queue_push(&queue, popped);
+    if(parser->token.kind == TOKEN_OPERATOR && c_charat(&parser->token.text, 0) == '-') {
+
+        if(!enter_rule(parser)) return -1;
+
+        next_token(parser);
+
+        int operand = parse_unary(parser);
+        parser->depth--;
+        if(operand < 0) return -1;
+
+        AstNode node = {
+
+            .kind = AST_NEG,
+            .lhs = operand
+        };
+
+        return ast_push(parser, node);
     }
 
-    assert(stack.count == 0);
+    return parse_primary(parser);
+}
 
-    while(queue.count > 0) {
+// power := unary ('^' power)?, right associative
+static int parse_power(Parser* parser) {
 
-        Element popped1 = queue_pop(&queue);
+    int base = parse_unary(parser);
 
-        if(popped1.kind == ELEMENT_NUM) stack_push(&stack, popped1);
-        else if(popped1.kind == ELEMENT_OP) {
+    if(base >= 0 && parser->token.kind == TOKEN_OPERATOR && c_charat(&parser->token.text, 0) == '^') {
 
-            switch(popped1.as.operator) {
+        if(!enter_rule(parser)) return -1;
 
-                case '^': {
+        next_token(parser);
+        int exponent = parse_power(parser);
+        parser->depth--;
 
-                    Element ret = {
+        return ast_binary(parser, '^', base, exponent);
+    }
 
-                        .kind = ELEMENT_NUM,
-                        .as.number = pow(stack.elements[stack.count - 2].as.number, stack.elements[stack.count - 1].as.number)
-                    };
+    return base;
+}
 
-                    stack_pop(&stack);
-                    stack_pop(&stack);
+// product := power (('*' | '/') power)*, left associative
+static int parse_product(Parser* parser) {
 
-                    stack_push(&stack, ret);
-                    break;
-                }
+    int lhs = parse_power(parser);
 
-                case '*': {
+    while(lhs >= 0 && parser->token.kind == TOKEN_OPERATOR) {
 
-                    Element ret = {
+        char operator = c_charat(&parser->token.text, 0);
+        if(operator != '*' && operator != '/') break;
 
-                        .kind = ELEMENT_NUM,
-                        .as.number = stack.elements[stack.count - 2].as.number * stack.elements[stack.count - 1].as.number
-                    };
+        next_token(parser);
+        lhs = ast_binary(parser, operator, lhs, parse_power(parser));
+    }
 
-                    stack_pop(&stack);
-                    stack_pop(&stack);
+    return lhs;
+}
 
-                    stack_push(&stack, ret);
-                    break;
-                }
+// sum := product (('+' | '-') product)*, left associative
+static int parse_sum(Parser* parser) {
 
-                case '/': {
+    int lhs = parse_product(parser);
 
-                    Element ret = {
+    while(lhs >= 0 && parser->token.kind == TOKEN_OPERATOR) {
 
-                        .kind = ELEMENT_NUM,
-                        .as.number = stack.elements[stack.count - 2].as.number / stack.elements[stack.count - 1].as.number
-                    };
+        char operator = c_charat(&parser->token.text, 0);
+        if(operator != '+' && operator != '-') break;
 
-                    stack_pop(&stack);
-                    stack_pop(&stack);
+        next_token(parser);
+        lhs = ast_binary(parser, operator, lhs, parse_product(parser));
+    }
 
-                    stack_push(&stack, ret);
-                    break;
-                }
+    return lhs;
+}
 
-                case '+': {
+int parse_formula(Parser* parser, StringStruct expr) {
 
-                    Element ret = {
+    parser->input = expr;
+    parser->count = 0;
+    parser->depth = 0;
+    parser->status = PARSE_OK;
 
-                        .kind = ELEMENT_NUM,
-                        .as.number = stack.elements[stack.count - 2].as.number + stack.elements[stack.count - 1].as.number
-                    };
+    next_token(parser);
 
-                    stack_pop(&stack);
-                    stack_pop(&stack);
+    if(parser->token.kind == TOKEN_END) return parse_error(parser, PARSE_EMPTY);
 
-                    stack_push(&stack, ret);
-                    break;
-                }
+    int root = parse_sum(parser);
 
-                case '-': {
+    if(root >= 0 && parser->token.kind != TOKEN_END) { //something is left over
 
-                    Element ret = {
+        return parse_error(parser, parser->token.kind == TOKEN_RPAREN ? PARSE_UNBALANCED : PARSE_INVALID);
+    }
 
-                        .kind = ELEMENT_NUM,
-                        .as.number = stack.elements[stack.count - 2].as.number - stack.elements[stack.count - 1].as.number
-                    };
+    return root;
+}
 
-                    stack_pop(&stack);
-                    stack_pop(&stack);
+static void emit_ast(Parser* parser, int index, Element* out, size_t* count) {
 
-                    stack_push(&stack, ret);
-                    break;
-                }
+    AstNode* node = &parser->nodes[index];
+    Element element = {0};
 
-                default: {
+    switch(node->kind) {
 
-                    assert(0 && "Unreachable code.");
-                }
+        case AST_NUM: {
+
+            element.kind = ELEMENT_NUM;
+            element.as.number = node->number;
+            break;
+        }
+
+        case AST_REF: {
+
+            element.kind = ELEMENT_REF;
+            element.as.cell.row = node->row;
+            element.as.cell.col = node->col;
+            break;
+        }
+
+        case AST_NEG: {
+
+            emit_ast(parser, node->lhs, out, count);
+            element.kind = ELEMENT_OP;
+            element.as.operator = '~';
+            break;
+        }
+
+        case AST_POWI: {
+
+            emit_ast(parser, node->lhs, out, count);
+            element.kind = ELEMENT_POWI;
+            element.as.exponent = node->exponent;
+            break;
+        }
+
+        case AST_BINARY: {
+
+            emit_ast(parser, node->lhs, out, count);
+            emit_ast(parser, node->rhs, out, count);
+            element.kind = ELEMENT_OP;
+            element.as.operator = node->operator;
+            break;
+        }
+
+        default: {
+
+            assert(0 && "Unreachable code.");
+        }
+    }
+
+    out[(*count)++] = element;
+}
+
+static bool is_constant(Parser* parser, int index) {
+
+    return parser->nodes[index].kind == AST_NUM;
+}
+
+// constant folding and strength reduction. rewrites nodes in place and returns the index of the optimized subtree
+int optimize_ast(Parser* parser, int index) {
+
+    AstNode* node = &parser->nodes[index];
+
+    switch(node->kind) {
+
+        case AST_NUM:
+        case AST_REF: {
+
+            return index;
+        }
+
+        case AST_NEG: {
+
+            node->lhs = optimize_ast(parser, node->lhs);
+            AstNode* operand = &parser->nodes[node->lhs];
+
+            if(operand->kind == AST_NUM) { //-c
+
+                node->kind = AST_NUM;
+                node->number = -operand->number;
+                return index;
             }
+
+            if(operand->kind == AST_NEG) return operand->lhs; //--x
+
+            return index;
+        }
+
+        case AST_POWI: {
+
+            node->lhs = optimize_ast(parser, node->lhs);
+            return index;
         }
+
+        case AST_BINARY: {
+
+            node->lhs = optimize_ast(parser, node->lhs);
+            node->rhs = optimize_ast(parser, node->rhs);
+
+            if(is_constant(parser, node->lhs) && is_constant(parser, node->rhs)) { //c op c
+
+                node->number = apply_operator(node->operator, parser->nodes[node->lhs].number, parser->nodes[node->rhs].number);
+                node->kind = AST_NUM;
+                return index;
+            }
+
+            if(!is_constant(parser, node->rhs)) return index;
+
+            double constant = parser->nodes[node->rhs].number;
+
+            if(node->operator == '^' && fabs(constant) <= OPTIMIZER_MAX_POWI && constant == (int)constant) { //x^n
+
+                if(constant == 1) return node->lhs;
+
+                node->kind = AST_POWI;
+                node->exponent = (int)constant;
+                return index;
+            }
+
+            int exponent;
+
+            //x / c into x * (1 / c), only when c is a power of two and 1 / c is normal, so the product rounds the same as the quotient
+            if(node->operator == '/' && fabs(frexp(constant, &exponent)) == 0.5 && isnormal(1 / constant)) {
+
+                parser->nodes[node->rhs].number = 1 / constant;
+                node->operator = '*';
+                return index;
+            }
+
+            return index;
+        }
+
+        default: {
+
+            assert(0 && "Unreachable code.");
+        }
+    }
+}
+
+// optimizes the parsed tree and turns it into a reverse polish program, every ast node becomes at most one element
+Formula compile_ast(Parser* parser, int root, Arena* arena) {
+
+    assert(root >= 0 && parser->status == PARSE_OK);
+
+    root = optimize_ast(parser, root);
+
+    Formula formula = {0};
+    formula.elements = arena_alloc(arena, sizeof(Element) * parser->count);
+
+    emit_ast(parser, root, formula.elements, &formula.count);
+
+    return formula;
+}
+
+double apply_operator(char operator, double lhs, double rhs) {
+
+    switch(operator) {
+
+        case '^': return pow(lhs, rhs);
+        case '*': return lhs * rhs;
+        case '/': return lhs / rhs;
+        case '+': return lhs + rhs;
+        case '-': return lhs - rhs;
+
+        default: {
+
+            assert(0 && "Unreachable code.");
+        }
+    }
+}
+
+// exponentiation by squaring, used instead of pow for small integer exponents
+double integer_power(double base, int exponent) {
+
+    unsigned int n = exponent < 0 ? -(unsigned int)exponent : (unsigned int)exponent;
+    double result = 1;
+
+    while(n > 0) {
+
+        if(n & 1) result *= base;
+        n >>= 1;
+        if(n > 0) base *= base;
     }
 
-    Element solution = stack_pop(&stack);
-    return solution.as.number;
+    return exponent < 0 ? 1 / result : result;
 }
 
+double evaluate_formula(Table* table, Formula* formula) {
+
+    assert(formula->count > 0);
 
-double solve_equation_with_numbers(Table* table, Node* node) {
+    double stack[formula->count];
+    size_t count = 0;
 
-    assert(table != NULL && node != NULL);
+    for(size_t i = 0; i < formula->count; i++) {
 
-    Cell* target_cell = cell_at(table, node->row, node->col);
+        Element* element = &formula->elements[i];
+
+        switch(element->kind) {
+
+            case ELEMENT_NUM: {
+
+                stack[count++] = element->as.number;
+                break;
+            }
 
-    StringStruct e = target_cell->as.expression.expr;
-    ss_cut_n(&e, 1); //strip off the '=' sign
-    e = ss_trim(e);
+            case ELEMENT_REF: {
+
+                stack[count++] = value_at(table, element->as.cell.row, element->as.cell.col);
+                break;
+            }
+
+            case ELEMENT_OP: {
+
+                if(element->as.operator == '~') {
+
+                    stack[count - 1] *= -1;
+                    break;
+                }
+
+                assert(count >= 2);
+                double rhs = stack[--count];
+                stack[count - 1] = apply_operator(element->as.operator, stack[count - 1], rhs);
+                break;
+            }
+
+            case ELEMENT_POWI: {
+
+                stack[count - 1] = integer_power(stack[count - 1], element->as.exponent);
+                break;
+            }
+
+            default: {
+
+                assert(0 && "Unreachable code.");
+            }
+        }
+    }
 
-    return shunting_yard(&e);
+    assert(count == 1);
+    return stack[0];
 }
 
 double solve_expression(Table* table, Node* node) {
 
-    Cell* target_cell = cell_at(table, node->row, node->col);
+    const Cell* target_cell = cell_at(table, node->row, node->col);
     assert(target_cell != NULL);
 
-    assert(target_cell->kind != KIND_TEXT);
-    assert(target_cell->kind != KIND_EMPTY);
+    assert(cell_kind(target_cell) != KIND_TEXT);
+    assert(cell_kind(target_cell) != KIND_EMPTY);
 
-    switch(target_cell->kind) { //poslednji u lancu moze biti ILI NUM ILI EXPRESSION SA BROJEVIMA
+    switch(cell_kind(target_cell)) { //poslednji u lancu moze biti ILI NUM ILI EXPRESSION SA BROJEVIMA
 
         case KIND_NUM: {
 
-            return target_cell->as.number;
+            return cell_number(target_cell);
         }
 
         case KIND_EXPR: {
 
-            target_cell->kind = KIND_NUM;
-            target_cell->as.number =  solve_equation_with_numbers(table, node);
-            return target_cell->as.number;
+            if(!cell_solved(target_cell)) { //reuse the cached value if nothing it depends on changed
+
+                store_value(table, node->row, node->col, evaluate_formula(table, &node->formula));
+                set_solved(cell_put(table, node->row, node->col), true);
+            }
+
+            return value_at(table, node->row, node->col);
         }
 
         default: {
@@ -249,129 +580,194 @@ double solve_expression(Table* table, Node* node) {
     }
 }
 
-StringStruct d_find_and_replace(StringStruct _base, StringStruct _replace_this, double _with_this) {
+void solve_expressions(Table* table, Graph* graph) {
+
+    if(solve_thread_count > 1 && graph->order_count >= PARALLEL_SOLVE_THRESHOLD) {
+
+        solve_expressions_parallel(table, graph, solve_thread_count);
+    }
+    else {
+
+        for(size_t i = 0; i < graph->order_count; i++) solve_expression(table, graph->order[i]);
+    }
+
+    //columns are shared between threads, so their widths catch up with the new values afterwards
+    for(size_t i = 0; i < graph->order_count; i++) refresh_width(table, graph->order[i]->row, graph->order[i]->col);
+}
+
+static int compare_rank(const void* a, const void* b) {
+
+    size_t lhs = (*(Node**)a)->rank;
+    size_t rhs = (*(Node**)b)->rank;
+
+    return (lhs > rhs) - (lhs < rhs);
+}
 
-    if(_base.count == 0 || _replace_this.count == 0) return _base;
+// marks every node downstream of the source dirty and collects them into the cone. returns how many there are
+size_t mark_dirty(Graph* graph, Node* source, Node** cone) {
 
-    char buffer[128];
-    memset(buffer, '\0', sizeof(buffer));
-    size_t iterator = 0;
+    Node** stack = arena_alloc(graph->scratch, sizeof(Node*) * (graph->count + 1));
 
-    char base[32];
-    memset(base, '\0', sizeof(base));
-    size_t base_iterator = 0;
+    size_t cone_count = 0;
+    size_t stack_count = 0;
 
-    char replace_this[32];
-    memset(replace_this, '\0', sizeof(replace_this));
-    size_t replace_iterator = 0;
+    stack[stack_count++] = source;
 
-    char with_this[32];
-    memset(with_this, '\0', sizeof(with_this));
-    size_t with_iterator = 0;
+    while(stack_count > 0) {
 
-    /*strncpy(base, _base.data, _base.count);
-    strncpy(replace_this, _replace_this.data, _replace_this.count);
-    strncpy(with_this, _with_this.data, _with_this.count);*/
+        Node* node = stack[--stack_count];
 
-    snprintf(base, _base.count + 1, "%s", _base.data);
-    snprintf(replace_this, _replace_this.count + 1, "%s", _replace_this.data);
-    sprintf(with_this, "%.04lf", _with_this);
+        for(size_t i = 0; i < node->dependent_count; i++) {
 
-    while(c_find_substring(base + base_iterator, replace_this) != -1) {
+            Node* dependent = node->dependents[i];
+            if(dependent->dirty || dependent->cyclic) continue; //everything downstream of a cycle is unsolved anyway
 
-        int index = c_find_substring(base + base_iterator, replace_this);
-        
-        strncpy(buffer + iterator, base + base_iterator, index);
-        iterator += index;
-        base_iterator += index + strlen(replace_this);
-        strncpy(buffer + iterator, with_this, strlen(with_this));
-        iterator += strlen(with_this);
+            dependent->dirty = true;
+            cone[cone_count++] = dependent;
+            stack[stack_count++] = dependent;
+        }
     }
 
-    strncpy(buffer + iterator, base + base_iterator, strlen(base + base_iterator));
-    iterator += strlen(base + base_iterator);
+    return cone_count;
+}
+
+// re-evaluates every cell downstream of the node, in evaluation order. returns how many were evaluated
+size_t recalculate_from(Table* table, Node* source) {
+
+    Graph* graph = table->graph;
+
+    Node** cone = arena_alloc(graph->scratch, sizeof(Node*) * (graph->count + 1));
+
+    size_t cone_count = mark_dirty(graph, source, cone);
+
+    qsort(cone, cone_count, sizeof(Node*), compare_rank);
+
+    for(size_t i = 0; i < cone_count; i++) {
 
-    buffer[iterator] = '\0';
-    
-    StringStruct ret = {0};
-    ret.count = strlen(buffer);
-    ret.data = strdup(buffer);
-    return ret;
+        store_value(table, cone[i]->row, cone[i]->col, evaluate_formula(table, &cone[i]->formula));
+        set_solved(cell_put(table, cone[i]->row, cone[i]->col), true);
+        refresh_width(table, cone[i]->row, cone[i]->col);
+        cone[i]->dirty = false;
+    }
+
+    return cone_count;
 }
 
-double dfs_solve(Table* table, Node* root, VisitedNodes* visited) {
+// drops the cached solutions downstream of the node, they are stale until the next solve
+void unsolve_from(Table* table, Node* source) {
 
-    assert(root != NULL);
+    Graph* graph = table->graph;
 
-    push_stack(visited, root);
+    Node** cone = arena_alloc(graph->scratch, sizeof(Node*) * (graph->count + 1));
 
-    //a cell can depend on a node thats either an expression or a number
+    size_t cone_count = mark_dirty(graph, source, cone);
 
-    //starting from here, find and replace all cell references with their solutions
+    for(size_t i = 0; i < cone_count; i++) {
 
-    for(size_t i = 0; i < root->count; i++) {
-        
-        //child's name
-        char buffer[5];
-        sprintf(buffer, "%c", 'A' + root->dependencies[i]->col);
-        sprintf(buffer + 1, "%d", root->dependencies[i]->row);
-        StringStruct cell_ref = ss_form_string_nt(buffer);
-            
-        Cell* parent_cell = cell_at(table, root->row, root->col);
-        Cell* child_cell = cell_at(table, root->dependencies[i]->row, root->dependencies[i]->col);
+        set_solved(cell_put(table, cone[i]->row, cone[i]->col), false);
+        clear_value(table, cone[i]->row, cone[i]->col);
+        refresh_width(table, cone[i]->row, cone[i]->col);
+    }
 
-        if(!was_visited(root->dependencies[i], visited)) {
-            
-            parent_cell->as.expression.expr = d_find_and_replace(parent_cell->as.expression.expr, cell_ref, dfs_solve(table, root->dependencies[i], visited));
-        }
-        else {
+}
 
-            parent_cell->as.expression.expr = d_find_and_replace(parent_cell->as.expression.expr, cell_ref, child_cell->as.number);
-        }
+void recalculate_cell(Table* table, int row, int col) {
+
+    if(table->graph == NULL) return; //never solved, nothing to keep up to date
+
+    arena_reset(&table->scratch);
+
+    Graph* graph = table->graph;
+    Node* node = lookup_node(graph, row, col);
+    const Cell* cell = cell_at(table, row, col);
+
+    if(node == NULL) {
+
+        if(cell_kind(cell) == KIND_EXPR) invalidate_solve(table); //new formula means new dependencies
+        return; //otherwise nothing depends on this cell
+    }
+
+    if(node->formula.count > 0 || cell_kind(cell) != KIND_NUM) { //formula changed or dependents now depend on a non number
+
+        unsolve_from(table, node);
+        invalidate_solve(table);
+        return;
     }
 
-    return solve_expression(table, root);
-    
+    size_t recalculated = recalculate_from(table, node);
+    printf(ANSI_GREEN "[SOLVE] Recalculated %zu dependent cells." ANSI_RESET "\n", recalculated);
 }
 
-void solve_expressions(Table* table, Node* root) {
+// forgets the last solve. its values go with it, without the graph nothing could keep them up to date
+void invalidate_solve(Table* table) {
 
-    VisitedNodes visited = {0};
+    if(table->graph == NULL) return;
 
-    for(size_t i = 0; i < root->count; i++) {
+    Graph* graph = table->graph;
 
-        if(!was_visited(root->dependencies[i], &visited)) {
+    for(size_t i = 0; i < graph->order_count; i++) {
 
-            dfs_solve(table, root->dependencies[i], &visited);
-        }
+        Node* node = graph->order[i];
+        const Cell* cell = cell_at(table, node->row, node->col);
+
+        if(cell_kind(cell) != KIND_EXPR || !cell_solved(cell)) continue; //numbers carry their value in the cell itself
+
+        set_solved(cell_put(table, node->row, node->col), false);
+        clear_value(table, node->row, node->col);
+        refresh_width(table, node->row, node->col);
     }
+
+    table->graph = NULL; //it lived in the arena
+    arena_reset(&table->arena);
+}
+
+static void print_solving(Graph* graph) {
+
+    if(graph->order_count < graph->count) {
+
+        printf(ANSI_YELLOW "\n[SOLVE] Solving everything except the %zu cells on or behind a cycle..." ANSI_RESET "\n", graph->count - graph->order_count);
+        return;
+    }
+
+    printf(ANSI_GREEN "\n[SOLVE] No errors found. Solving..." ANSI_RESET"\n");
 }
 
 void solve_table(Table* table) {
 
-    Node* root = perform_syntax_analysis(table);
+    arena_reset(&table->scratch);
 
-    if(root->count == 0) {
+    if(table->graph != NULL) { //nothing structural changed since the last solve, reuse its order
 
-        printf(ANSI_GREEN "\n[SOLVE] There is nothing to solve.\n" ANSI_RESET);
+        print_solving(table->graph);
+        solve_expressions(table, table->graph);
         return;
     }
 
-    if(cycles_exist(root)) {
+    Graph graph = perform_syntax_analysis(table);
+    Node* root = graph.root;
 
-        printf(ANSI_BOLD_RED"\n[SOLVE] Terminated abnormally.\n" ANSI_RESET);
+    if(root->count == 0) {
+
+        printf(ANSI_GREEN "\n[SOLVE] There is nothing to solve.\n" ANSI_RESET);
+        arena_reset(&table->arena);
         return;
     }
 
-    if(invalid_dependencies_exist(table, root)) {
+    find_cycles(&graph); //reported, their cells are left out of the order below and stay unsolved
+
+    if(invalid_dependencies_exist(table, &graph)) {
 
         printf(ANSI_BOLD_RED"\n[SOLVE] Terminated abnormally.\n" ANSI_RESET);
+        arena_reset(&table->arena);
         return;
     }
 
-    printf(ANSI_GREEN "\n[SOLVE] No errors found. Solving..." ANSI_RESET"\n");
+    schedule_graph(&graph);
+
+    table->graph = arena_alloc(&table->arena, sizeof(Graph));
+    *table->graph = graph;
 
-    solve_expressions(table, root);
+    print_solving(table->graph);
 
-    calculate_new_cell_width(table);
-}
\ No newline at end of file
+    solve_expressions(table, table->graph);
+}
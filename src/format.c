@@ -0,0 +1,147 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include "format.h"
+
+static const uint64_t powers_of_ten[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+
+static const char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// writes the digits of value backwards from end two at a time, returns where they start
+static char* write_digits(uint64_t value, char* end) {
+
+    while(value >= 100) {
+
+        end -= 2;
+        memcpy(end, &digit_pairs[(value % 100) * 2], 2);
+        value /= 100;
+    }
+
+    if(value >= 10) {
+
+        end -= 2;
+        memcpy(end, &digit_pairs[value * 2], 2);
+    }
+    else {
+
+        *--end = (char)('0' + value);
+    }
+
+    return end;
+}
+
+// same text as printf's "%.*f", worked out from the exact binary value so rounding is the same (to nearest, ties to even).
+// returns 0 for what it doesn't cover, values of 2^63 and up, below 2^-48, inf and nan, which are left to printf
+size_t format_fixed(double value, int precision, char* out) {
+
+    assert(precision >= 0 && precision < (int)(sizeof(powers_of_ten) / sizeof(powers_of_ten[0])));
+
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    bool negative = bits >> 63;
+    int exponent = (int)((bits >> 52) & 0x7FF);
+    uint64_t mantissa = bits & ((1ull << 52) - 1);
+
+    uint64_t integral = 0;
+    unsigned __int128 fraction = 0;     // fraction / 2^shift is the part after the point
+    int shift = 0;
+
+    if(exponent == 0x7FF) return 0;
+
+    if(exponent != 0) {
+
+        mantissa |= 1ull << 52;
+        shift = 1075 - exponent;        // value is mantissa / 2^shift
+
+        if(shift < 0) {
+
+            if(shift < -10) return 0;
+            integral = mantissa << -shift;
+            shift = 0;
+        }
+        else if(shift > 100) {
+
+            return 0;
+        }
+        else {
+
+            integral = shift < 64 ? mantissa >> shift : 0;
+            fraction = shift < 64 ? mantissa & ((1ull << shift) - 1) : mantissa;
+        }
+    }
+    else if(mantissa != 0) { //subnormals
+
+        return 0;
+    }
+
+    uint64_t scale = powers_of_ten[precision];
+    uint64_t decimals = 0;
+    uint64_t last = 0;                  // digit a tie rounds to even, the last decimal or the units without decimals
+
+    uint64_t scaled;
+
+    if(shift > 0 && shift < 64 && !__builtin_mul_overflow((uint64_t)fraction, scale, &scaled)) { //usual case, no need for 128 bits
+
+        uint64_t remainder = scaled & ((1ull << shift) - 1);
+        uint64_t half = 1ull << (shift - 1);
+
+        decimals = scaled >> shift;
+        last = precision > 0 ? decimals : integral;
+        if(remainder > half || (remainder == half && (last & 1))) decimals++;
+    }
+    else if(shift > 0) {
+
+        unsigned __int128 wide = fraction * scale;
+        unsigned __int128 remainder = wide & (((unsigned __int128)1 << shift) - 1);
+        unsigned __int128 half = (unsigned __int128)1 << (shift - 1);
+
+        decimals = (uint64_t)(wide >> shift);
+        last = precision > 0 ? decimals : integral;
+        if(remainder > half || (remainder == half && (last & 1))) decimals++;
+    }
+
+    if(decimals == scale) {
+
+        decimals = 0;
+        integral++;
+    }
+
+    char digits[FORMAT_BUFFER_SIZE];
+    char* end = digits + sizeof(digits);
+    char* start = end;
+
+    if(precision > 0) {
+
+        start = write_digits(decimals, end);
+        while(end - start < precision) *--start = '0';
+        *--start = '.';
+    }
+
+    start = write_digits(integral, start);
+    if(negative) *--start = '-';
+
+    size_t length = end - start;
+    memcpy(out, start, length);
+
+    return length;
+}
+
+size_t format_int(long long value, char* out) {
+
+    char digits[FORMAT_BUFFER_SIZE];
+    char* end = digits + sizeof(digits);
+    char* start = write_digits(value < 0 ? 0 - (uint64_t)value : (uint64_t)value, end);
+
+    if(value < 0) *--start = '-';
+
+    size_t length = end - start;
+    memcpy(out, start, length);
+
+    return length;
+}
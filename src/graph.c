@@ -1,91 +1,157 @@
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "graph.h"
 #include "ss.h"
 #include "table.h"
+#include "columns.h"
 #include "equation_solver.h"
 
-extern int expression_count;
+Node* make_root(Arena* arena, int expression_count) {
 
-Node* make_root(int expression_count) {
+    Node* root = arena_alloc(arena, sizeof(Node));
 
-    Node* root = malloc(sizeof(Node));
-    assert(root != NULL);
-
-    root->row = -2;
-    root->col = -2;
-    root->dependencies = NULL;
-    root->count;
+    Node blank = MKNode(-2, -2);
+    *root = blank;
 
     if(expression_count > 0) {
 
-        root->dependencies = malloc(sizeof(Node*) * expression_count);
-        assert(root->dependencies != NULL);
-        memset(root->dependencies, 0, sizeof(Node*) * expression_count);
+        root->dependencies = arena_calloc(arena, expression_count, sizeof(Node*));
     }
 
     return root;
 }
 
+Graph make_graph(Table* table) {
+
+    Graph graph = {0};
+    graph.arena = &table->arena;
+    graph.scratch = &table->scratch;
+    graph.root = make_root(graph.arena, table->expression_count);
+    graph.rows = table->rows;
+    graph.cols = table->cols;
+
+    graph.slot_count = GRAPH_INDEX_INITIAL_SIZE;
+    while(graph.slot_count < (size_t)table->expression_count * 4) graph.slot_count *= 2; //room for every formula and a few references each
+    graph.slots = arena_calloc(graph.arena, graph.slot_count, sizeof(Node*));
+
+    return graph;
+}
+
+VisitedNodes make_visited(Arena* arena, size_t count) {
+
+    size_t words = (count + 63) / 64;
+
+    VisitedNodes visited = {0};
+    visited.bits = arena_calloc(arena, words > 0 ? words : 1, sizeof(uint64_t));
+
+    return visited;
+}
+
 bool was_visited(Node* root, VisitedNodes* visited) {
 
-    for(size_t i = 0; i < visited->count; i++) {
+    size_t index = root->id;
+    return (visited->bits[index / 64] >> (index % 64)) & 1;
+}
 
-        if(visited->nodes[i] == root) return true;
-    }
-    return false;
+void mark_visited(Node* root, VisitedNodes* visited) {
+
+    size_t index = root->id;
+    visited->bits[index / 64] |= (uint64_t)1 << (index % 64);
+}
+
+void unmark_visited(Node* root, VisitedNodes* visited) {
+
+    size_t index = root->id;
+    visited->bits[index / 64] &= ~((uint64_t)1 << (index % 64));
 }
 
-Node* dfs(Node* root, Node* target, VisitedNodes* visited) {
+Recstack make_recstack(Arena* arena, size_t count) {
+
+    Recstack recstack = {0};
+    recstack.arena = arena;
+    recstack.members = make_visited(arena, count);
+    recstack.capacity = RECSTACK_INITIAL_SIZE;
+    recstack.nodes = arena_alloc(arena, sizeof(Node*) * recstack.capacity);
 
-    assert(root != NULL);
+    return recstack;
+}
 
-    //check if it was visited already
-    if(was_visited(root, visited)) return NULL;
+void grow_recstack(Recstack* recstack) {
 
-    if(root->col == target->col && root->row == target->row) {
+    recstack->nodes = arena_grow(recstack->arena, recstack->nodes, sizeof(Node*) * recstack->capacity, sizeof(Node*) * recstack->capacity * 2);
+    recstack->capacity *= 2;
+}
 
-        //found it
-        return root;
-    }
+// linear probing from a fibonacci hash of the cell, ends on the node's slot or the free slot it would go in
+static size_t node_slot(Node** slots, size_t slot_count, int cols, int row, int col) {
 
-    //mark as visited
-    push_stack(visited, root);
+    uint64_t key = (uint64_t)row * cols + col;
+    size_t mask = slot_count - 1;
+    size_t slot = (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
 
-    for(size_t i = 0; i < root->count; i++) {
+    while(slots[slot] != NULL && (slots[slot]->row != row || slots[slot]->col != col)) slot = (slot + 1) & mask;
 
-        Node* ret = dfs(root->dependencies[i], target, visited);
+    return slot;
+}
+
+static void grow_index(Graph* graph) {
+
+    size_t slot_count = graph->slot_count * 2;
+    Node** slots = arena_calloc(graph->arena, slot_count, sizeof(Node*));
+
+    for(size_t i = 0; i < graph->count; i++) {
 
-        if(ret != NULL) return ret;
+        Node* node = graph->list[i];
+        slots[node_slot(slots, slot_count, graph->cols, node->row, node->col)] = node;
     }
 
-    return NULL;
+    graph->slots = slots;
+    graph->slot_count = slot_count;
 }
 
-Node* find_node(Node* root, Node* target) {
+Node* lookup_node(Graph* graph, int row, int col) {
 
-    VisitedNodes visited = {0};
+    return graph->slots[node_slot(graph->slots, graph->slot_count, graph->cols, row, col)];
+}
+
+Node* find_node(Graph* graph, Node* target) {
+
+    assert(target->row >= 0 && target->row < graph->rows);
+    assert(target->col >= 0 && target->col < graph->cols);
 
-    return dfs(root, target, &visited);
+    return lookup_node(graph, target->row, target->col);
 }
 
-Node* alloc_new_node(Node* target) {
+Node* alloc_new_node(Graph* graph, Node* target) {
 
-    Node* newNode = malloc(sizeof(Node));
-    assert(newNode != NULL);
+    Node* newNode = arena_alloc(graph->arena, sizeof(Node));
 
-    newNode->row = target->row;
-    newNode->col = target->col;
-    newNode->count = 0;
-    newNode->dependencies = NULL;
+    Node blank = MKNode(target->row, target->col);
+    *newNode = blank;
+
+    if((graph->count + 1) * 2 > graph->slot_count) grow_index(graph);
+
+    graph->slots[node_slot(graph->slots, graph->slot_count, graph->cols, target->row, target->col)] = newNode;
+
+    if(graph->count == graph->capacity) {
+
+        size_t capacity = graph->capacity == 0 ? GRAPH_LIST_INITIAL_SIZE : graph->capacity * 2;
+        graph->list = arena_grow(graph->arena, graph->list, sizeof(Node*) * graph->capacity, sizeof(Node*) * capacity);
+        graph->capacity = capacity;
+    }
+
+    newNode->id = graph->count;
+    graph->list[graph->count++] = newNode;
 
     return newNode;
 }
 
-void add_node(Node* root, Node* source, Node* target) {
+void add_node(Graph* graph, Node* source, Node* target) {
 
-    Node* found_target = find_node(root, target);
+    Node* found_target = find_node(graph, target);
 
     if(found_target != NULL) { //exists, just append dependency
 
@@ -93,259 +159,358 @@ void add_node(Node* root, Node* source, Node* target) {
         return;
     }
         
-    source->dependencies[source->count++] = alloc_new_node(target); //doesn't, create new dependency
+    source->dependencies[source->count++] = alloc_new_node(graph, target); //doesn't, create new dependency
 }
 
-void handle_expression(Node* root, Node* values, size_t count) {
+void handle_expression(Graph* graph, Node* values, size_t count) {
 
-    Node* source = find_node(root, &values[0]);
+    Node* source = find_node(graph, &values[0]);
 
     if(source == NULL) { //lhs of the equation doesnt exist in the graph
 
-        Node* newNode = alloc_new_node(&values[0]);
-        newNode->dependencies = malloc(sizeof(Node*) * count - 1);
-        assert(newNode->dependencies != NULL);
-        
-        memset(newNode->dependencies, 0, sizeof(Node*) * count - 1);
+        Node* newNode = alloc_new_node(graph, &values[0]);
+        newNode->dependencies = arena_calloc(graph->arena, count - 1, sizeof(Node*));
 
         source = newNode;
 
-        root->dependencies[root->count++] = newNode;
+        graph->root->dependencies[graph->root->count++] = newNode;
     }
     else {
 
         if(source->dependencies == NULL) {
 
-            source->dependencies = malloc(sizeof(Node*) * count - 1);
-            assert(source->dependencies != NULL);
+            source->dependencies = arena_alloc(graph->arena, sizeof(Node*) * (count - 1));
         }
     }
 
+    source->formula = values[0].formula;
+
     for(size_t i = 1; i < count; i++) {
 
-        add_node(root, source, &values[i]);
+        add_node(graph, source, &values[i]);
     }
 }
 
-Node* perform_syntax_analysis(Table* table) {
+// parses the formula of an expression cell and adds it and every cell it references to the graph
+static void analyse_cell(Graph* graph, Parser* parser, Table* table, int row, int col) {
 
-    //root uvek postoji
-    char syntax_errors[SYNTAX_ERRORS_BUFF_SIZE];
-    size_t syntax_buffer_iterator = 0;
-    memset(syntax_errors, '\0', sizeof(syntax_errors));
+    if(cell_kind(cell_at(table, row, col)) != KIND_EXPR) return;
 
-    Node* root = make_root(expression_count);
-    
-    for(int row = 0; row < table->rows; row++) {
+    Cell* cell = cell_put(table, row, col); //the tile exists, the cell holds a formula
 
-        for(int col = 0; col < table->cols; col++) {
+    set_expr_kind(cell, EXPR_VALID); //invalidated during processing if its invalid
+    set_solved(cell, false); //the graph is rebuilt, every value gets solved again
+    clear_value(table, row, col);
+    refresh_width(table, row, col);
 
-            Cell* cell = cell_at(table, row, col);
+    StringStruct formula = cell_text(table, cell);
+    StringStruct expr = formula;
+    ss_cut_n(&expr, 1); //cut the '=' sign
 
-            if(cell->kind == KIND_EXPR) {
+    int ast = parse_formula(parser, expr);
+    StringStruct token = parser->error_token;
 
-                //node buffer, implemented here in temporary memory to avoid having to allocate an unknown amount of spaces for
-                //cell dependencies. also wanted to avoid duplicating the entire function.
+    char name[COLUMN_NAME_SIZE];
+    column_name(col, name);
 
-                Node current_cell = MKNode(row, col);
-                cell->as.expression.kind = EXPR_VALID; //invalidated during processing if its invalid
+    //column letters of an out of bounds reference, the row follows them
+    StringStruct letters = ss_form_string(token.data, 0);
+    while(letters.count < token.count && c_isupper(token.data[letters.count])) letters.count++;
 
-                Node referenced_cells[GRAPH_NODE_BUFFER_SIZE] = {0}; 
-                size_t buffer_count = 0;
-                referenced_cells[buffer_count++] = current_cell;
+    switch(parser->status) {
 
-                StringStruct expr = cell->as.expression.expr;
-                ss_cut_n(&expr, 1); //cut the '=' sign
-                expr = ss_trim(expr);
+        case PARSE_OK: break;
 
-                if(expr.count == 0) {
+        case PARSE_EMPTY: {
 
-                    cell->as.expression.kind = EXPR_INVALID;
-                    syntax_buffer_iterator += sprintf(syntax_errors + syntax_buffer_iterator, ANSI_RED"[SYNTAX ERROR] Empty expression in cell "ANSI_BOLD_RED"%c%d"ANSI_RESET ANSI_RED".\n"ANSI_RESET, (char)('A' + col), row);
-                    continue;
-                }
+            fprintf(stderr, ANSI_RED"[SYNTAX ERROR] Empty expression in cell "ANSI_BOLD_RED"%s%d"ANSI_RESET ANSI_RED".\n"ANSI_RESET, name, row);
+            break;
+        }
+
+        case PARSE_DANGLING_OPERATOR: {
+
+            fprintf(stderr, ANSI_RED"[SYNTAX ERROR] Dangling operator in cell "ANSI_BOLD_RED"%s%d"ANSI_RESET ANSI_RED" :\""SSFormat"\"\n" ANSI_RESET, name, row, SSArg(formula));
+            break;
+        }
+
+        case PARSE_UNBALANCED: {
+
+            fprintf(stderr, ANSI_RED"[SYNTAX ERROR] Unbalanced parentheses in cell "ANSI_BOLD_RED"%s%d"ANSI_RESET ANSI_RED" :\""SSFormat"\"\n" ANSI_RESET, name, row, SSArg(formula));
+            break;
+        }
+
+        case PARSE_TOO_LONG: {
 
-                while(expr.count > 0) {
-                    
-                    //bool negative = false;
-                    if(c_charat(&expr, 0) == '-') {
+            fprintf(stderr, ANSI_RED"[SYNTAX ERROR] Expression in cell "ANSI_BOLD_RED"%s%d"ANSI_RESET ANSI_RED" is too long.\n"ANSI_RESET, name, row);
+            break;
+        }
 
-                        //negative = true;
-                        ss_cut_n(&expr, 1);
-                        expr = ss_trim(expr);
-                    }
+        case PARSE_OOB_COL: {
 
-                    char c = find_first_operator(expr);
-                    int out_row = 0;
-                    int out_col = 0;
+            fprintf(stderr, 
+            ANSI_RED"[OOB ERROR] Cell " ANSI_BOLD_RED SSFormat ANSI_RESET ANSI_RED" used in expression in "ANSI_BOLD_RED"%s%d"ANSI_RESET ANSI_RED" but column "ANSI_BOLD_RED SSFormat ANSI_RESET ANSI_RED" doesn't exist in the table." ANSI_RESET"\n",
+            SSArg(token), name, row, SSArg(letters));
+            break;
+        }
 
-                    if(c != '\0') {
+        case PARSE_OOB_ROW: {
 
-                        //ima operator
+            StringStruct copy = token;
+            ss_cut_n(&copy, letters.count);
 
-                        StringStruct token = ss_trim(ss_cut_by_delim(&expr, c));
-                        expr = ss_trim(expr); //ready the next token
+            fprintf(stderr, 
+            ANSI_RED"[OOB ERROR] Cell " ANSI_BOLD_RED SSFormat ANSI_RESET ANSI_RED" used in expression in "ANSI_BOLD_RED"%s%d"ANSI_RESET ANSI_RED" but row "ANSI_BOLD_RED SSFormat ANSI_RESET ANSI_RED" doesn't exist in the table." ANSI_RESET"\n",
+            SSArg(token), name, row, SSArg(copy));
+            break;
+        }
 
-                        if(expr.count == 0) { //posle cuttovanja operatora nema nista -> dangling operator
+        default: {
 
-                            cell->as.expression.kind = EXPR_INVALID;
-                            syntax_buffer_iterator += sprintf(syntax_errors + syntax_buffer_iterator, ANSI_RED"[SYNTAX ERROR] Dangling operator in cell "ANSI_BOLD_RED"%c%d"ANSI_RESET ANSI_RED" :\""SSFormat"\"\n" ANSI_RESET, (char)('A' + col), row, SSArg(cell->as.expression.expr));
-                            break;
-                        }
- 
+            fprintf(stderr, ANSI_RED"[SYNTAX ERROR] Invalid expression in cell "ANSI_BOLD_RED"%s%d"ANSI_RESET ANSI_RED" :\""SSFormat"\"\n" ANSI_RESET, name, row, SSArg(formula));
+            break;
+        }
+    }
 
-                        if(ss_isnumber(token)) {} //if its a number, do nothing
-                        else if(token_iscellref(table, token, &out_row, &out_col)) { //if its a cell ref add it
+    if(parser->status != PARSE_OK) {
 
-                            Node dep = MKNode(out_row, out_col);
+        set_expr_kind(cell, EXPR_INVALID);
+        return;
+    }
 
-                            referenced_cells[buffer_count++] = dep;
-                            assert(buffer_count < GRAPH_NODE_BUFFER_SIZE); //to crash before segfault to alert the user of there being
-                                                                           //too many cell references.   
-                        }
-                        else { //if its neither, report and continue
+    //the cell itself first, then every cell it references
+    Node referenced_cells[parser->count + 1];
+    size_t buffer_count = 0;
 
-                            if(out_row == -1 && out_col == -1){
+    Node current_cell = MKNode(row, col);
+    referenced_cells[buffer_count++] = current_cell;
 
-                                cell->as.expression.kind = EXPR_INVALID;
-                                syntax_buffer_iterator += sprintf(syntax_errors + syntax_buffer_iterator, ANSI_RED"[SYNTAX ERROR] Invalid expression in cell "ANSI_BOLD_RED"%c%d"ANSI_RESET ANSI_RED" :\""SSFormat"\"\n" ANSI_RESET, (char)('A' + col), row, SSArg(cell->as.expression.expr));
-                                break;
-                            }
-                            else if(out_row == -2 && out_col == -2) { //out_of_bounds_col
+    for(size_t i = 0; i < parser->count; i++) {
 
-                                cell->as.expression.kind = EXPR_INVALID;
-                                syntax_buffer_iterator += sprintf(syntax_errors + syntax_buffer_iterator, 
-                                ANSI_RED"[OOB ERROR] Cell " ANSI_BOLD_RED SSFormat ANSI_RESET ANSI_RED" used in expression in "ANSI_BOLD_RED"%c%d"ANSI_RESET ANSI_RED" but column "ANSI_BOLD_RED"%c"ANSI_RESET ANSI_RED" doesn't exist in the table." ANSI_RESET"\n",
-                                SSArg(token), 'A' + col, row, c_charat(&token, 0));
-                                break;
+        if(parser->nodes[i].kind != AST_REF) continue;
 
-                            } 
-                            else if(out_row == -3 && out_col == -3) { //out_of_bounds_row
+        Node dep = MKNode(parser->nodes[i].row, parser->nodes[i].col);
+        referenced_cells[buffer_count++] = dep;
+    }
 
-                                StringStruct copy = token;
-                                ss_cut_n(&copy, 1);
+    referenced_cells[0].formula = compile_ast(parser, ast, graph->arena);
+    handle_expression(graph, referenced_cells, buffer_count);
+}
 
-                                cell->as.expression.kind = EXPR_INVALID;
-                                syntax_buffer_iterator += sprintf(syntax_errors + syntax_buffer_iterator, 
-                                ANSI_RED"[OOB ERROR] Cell " ANSI_BOLD_RED SSFormat ANSI_RESET ANSI_RED" used in expression in "ANSI_BOLD_RED"%c%d"ANSI_RESET ANSI_RED" but row "ANSI_BOLD_RED SSFormat ANSI_RESET ANSI_RED" doesn't exist in the table." ANSI_RESET"\n",
-                                SSArg(token), 'A' + col, row, SSArg(copy));
-                                break;
-                            }  
-                        }
+static int compare_tiles(const void* a, const void* b) {
 
-                    } else {
+    const Tile* lhs = *(Tile* const*)a;
+    const Tile* rhs = *(Tile* const*)b;
 
-                        //ceo ostatak je token                          //+1 to make sure its the entire thing
-                        StringStruct token = ss_trim(ss_cut_n(&expr, expr.count + 1));
-                        assert(expr.count == 0);
+    if(lhs->row != rhs->row) return (lhs->row > rhs->row) - (lhs->row < rhs->row);
+    return (lhs->col > rhs->col) - (lhs->col < rhs->col);
+}
 
-                        if(ss_isnumber(token)) {} //do nothing if its a number
-                        else if(token_iscellref(table, token, &out_row, &out_col)) {
+Graph perform_syntax_analysis(Table* table) {
 
-                            Node dep = MKNode(out_row, out_col);
-                            referenced_cells[buffer_count++] = dep;
+    //root uvek postoji
+    Graph graph = make_graph(table);
+    Parser parser = {0};
+    parser.table = table;
 
-                        }
-                        else {
+    //only tiles that exist are visited, so empty regions cost nothing. they are sorted into bands of TILE_SIZE rows
+    //and every band is walked row by row across its tiles, which keeps cells and their messages in row major order
+    size_t tile_count = table->tile_count;
+    Tile** tiles = arena_alloc(&table->scratch, sizeof(Tile*) * (tile_count > 0 ? tile_count : 1));
+    memcpy(tiles, table->tile_list, sizeof(Tile*) * tile_count);
+    qsort(tiles, tile_count, sizeof(Tile*), compare_tiles);
 
-                            if(out_row == -1 && out_col == -1){
+    for(size_t band = 0, band_end = 0; band < tile_count; band = band_end) {
 
-                                cell->as.expression.kind = EXPR_INVALID;
-                                syntax_buffer_iterator += sprintf(syntax_errors + syntax_buffer_iterator, ANSI_RED"[SYNTAX ERROR] Invalid expression in cell "ANSI_BOLD_RED"%c%d"ANSI_RESET ANSI_RED" :\""SSFormat"\"\n" ANSI_RESET, (char)('A' + col), row, SSArg(cell->as.expression.expr));
-                                break;
-                            }
-                            else if(out_row == -2 && out_col == -2) { //out_of_bounds_col
+        while(band_end < tile_count && tiles[band_end]->row == tiles[band]->row) band_end++;
 
-                                cell->as.expression.kind = EXPR_INVALID;
-                                syntax_buffer_iterator += sprintf(syntax_errors + syntax_buffer_iterator, 
-                                ANSI_RED"[OOB ERROR] Cell " ANSI_BOLD_RED SSFormat ANSI_RESET ANSI_RED" used in expression in "ANSI_BOLD_RED"%c%d"ANSI_RESET ANSI_RED" but column "ANSI_BOLD_RED"%c"ANSI_RESET ANSI_RED" doesn't exist in the table." ANSI_RESET"\n",
-                                SSArg(token), 'A' + col, row, c_charat(&token, 0));
-                                break;
+        int last_row = tiles[band]->row + TILE_SIZE < table->rows ? tiles[band]->row + TILE_SIZE : table->rows;
 
-                            } 
-                            else if(out_row == -3 && out_col == -3) { //out_of_bounds_row
+        for(int row = tiles[band]->row; row < last_row; row++) {
 
-                                StringStruct copy = token;
-                                ss_cut_n(&copy, 1);
+            for(size_t i = band; i < band_end; i++) {
 
-                                cell->as.expression.kind = EXPR_INVALID;
-                                syntax_buffer_iterator += sprintf(syntax_errors + syntax_buffer_iterator, 
-                                ANSI_RED"[OOB ERROR] Cell " ANSI_BOLD_RED SSFormat ANSI_RESET ANSI_RED" used in expression in "ANSI_BOLD_RED"%c%d"ANSI_RESET ANSI_RED" but row "ANSI_BOLD_RED SSFormat ANSI_RESET ANSI_RED" doesn't exist in the table." ANSI_RESET"\n",
-                                SSArg(token), 'A' + col, row, SSArg(copy));
-                                break;
-                            } 
-                        }     
-                    }
-                }
+                int last_col = tiles[i]->col + TILE_SIZE < table->cols ? tiles[i]->col + TILE_SIZE : table->cols;
 
-                if(cell->as.expression.kind == EXPR_INVALID) continue;
-                handle_expression(root, referenced_cells, buffer_count);
+                for(int col = tiles[i]->col; col < last_col; col++) analyse_cell(&graph, &parser, table, row, col);
             }
         }
     }
 
-    fprintf(stderr, "%s\n", syntax_errors);
-    return root;
+    fprintf(stderr, "\n");
+    return graph;
 }
 
-bool dfs_cycle(Node* root, VisitedNodes* visited, Recstack* recstack) {
+static void scc_visit(Node* node, int* next_index, Node** scc_stack, size_t* scc_count) {
 
-    assert(root != NULL);
+    node->index = node->lowlink = (*next_index)++;
+    node->on_stack = true;
+    scc_stack[(*scc_count)++] = node;
+}
 
-    push_stack(visited, root); // add it do list of visited nodes so that i call dfs for every node once
-    push_stack(recstack, root); //add it to the path currently being taken
+void report_cycle(Node** members, size_t count) {
+
+    char name[COLUMN_NAME_SIZE];
+
+    fprintf(stderr, ANSI_RED "[CYCLE CHECK] A dependency cycle was found between these cells:\n" ANSI_RESET);
+
+    for(size_t i = 0; i < count - 1; i++) {
+
+        fprintf(stderr, "%s%d, ", column_name(members[i]->col, name), members[i]->row);
+    }
+
+    fprintf(stderr, "%s%d\n", column_name(members[count - 1]->col, name), members[count - 1]->row);
+}
+
+// iterative tarjan, every node and edge is visited once. marks and reports every component that is a cycle
+size_t find_cycles(Graph* graph) {
+
+    typedef struct {
+        Node* node;
+        size_t next;    // next dependency to look at
+    } Frame;
+
+    Frame* frames = arena_alloc(graph->scratch, sizeof(Frame) * (graph->count + 1));
+    Node** scc_stack = arena_alloc(graph->scratch, sizeof(Node*) * (graph->count + 1));
+
+    size_t frame_count = 0;
+    size_t scc_count = 0;
+    int next_index = 0;
+    size_t cycles = 0;
+
+    Node* root = graph->root;
 
     for(size_t i = 0; i < root->count; i++) {
 
-        if(!was_visited(root->dependencies[i], visited)) { //if not visited, visit
+        if(root->dependencies[i]->index != -1) continue;
 
-            if(dfs_cycle(root->dependencies[i], visited, recstack)) return true;
-        }
-        else if(was_visited(root->dependencies[i], recstack)) { //IS IT IN RECSTACK
+        scc_visit(root->dependencies[i], &next_index, scc_stack, &scc_count);
+        frames[frame_count++] = (Frame){ root->dependencies[i], 0 };
+
+        while(frame_count > 0) {
+
+            Frame* frame = &frames[frame_count - 1];
+            Node* node = frame->node;
+
+            if(frame->next < node->count) {
+
+                Node* dependency = node->dependencies[frame->next++];
+
+                if(dependency->index == -1) {
+
+                    scc_visit(dependency, &next_index, scc_stack, &scc_count);
+                    frames[frame_count++] = (Frame){ dependency, 0 };
+                }
+                else if(dependency->on_stack && dependency->index < node->lowlink) {
+
+                    node->lowlink = dependency->index;
+                }
+
+                continue;
+            }
+
+            frame_count--; //done with this node, propagate its lowlink to the caller
+
+            if(frame_count > 0 && node->lowlink < frames[frame_count - 1].node->lowlink) {
+
+                frames[frame_count - 1].node->lowlink = node->lowlink;
+            }
+
+            if(node->lowlink != node->index) continue; //not the root of its component
+
+            size_t start = scc_count;
+            do {
+                start--;
+                scc_stack[start]->on_stack = false;
+
+            } while(scc_stack[start] != node);
+
+            size_t members = scc_count - start;
+            bool self_loop = false;
 
-            push_stack(recstack, root->dependencies[i]);
-            return true;
+            for(size_t j = 0; j < node->count; j++) {
+
+                if(node->dependencies[j] == node) self_loop = true;
+            }
+
+            if(members > 1 || self_loop) {
+
+                for(size_t j = start; j < scc_count; j++) scc_stack[j]->cyclic = true;
+
+                report_cycle(scc_stack + start, members);
+                cycles++;
+            }
+
+            scc_count = start;
         }
     }
 
-    pop_stack(recstack); //pop from the path if we're backtracking
-    return false;
+    return cycles;
 }
 
-void report_cycle(Recstack* recstack) {
+void build_dependents(Graph* graph) {
+
+    for(size_t i = 0; i < graph->count; i++) {
 
-    char buffer[GRAPH_CYCLE_BUFFER_SIZE];
-    memset(buffer, '\0', sizeof(buffer));
-    size_t buffer_iterator = 0;
-                
-    buffer_iterator += sprintf(buffer + buffer_iterator, ANSI_RED "[CYCLE CHECK] A dependency cycle was found:\n" ANSI_RESET);
+        Node* node = graph->list[i];
 
-    for(size_t i = 0; i < recstack->count - 1; i++) {
+        for(size_t j = 0; j < node->count; j++) node->dependencies[j]->dependent_count++;
+    }
+
+    for(size_t i = 0; i < graph->count; i++) {
+
+        Node* node = graph->list[i];
+
+        if(node->dependent_count > 0) {
 
-        buffer_iterator += sprintf(buffer + buffer_iterator, "%c%d -> ", 'A' + recstack->nodes[i]->col, recstack->nodes[i]->row);
+            node->dependents = arena_alloc(graph->arena, sizeof(Node*) * node->dependent_count);
+        }
+
+        node->dependent_count = 0; //reused as the fill cursor below
     }
 
-    sprintf(buffer + buffer_iterator, "%c%d\n", 'A' + recstack->nodes[recstack->count - 1]->col, recstack->nodes[recstack->count - 1]->row);
-                
-    fprintf(stderr, "%s", buffer);
+    for(size_t i = 0; i < graph->count; i++) {
+
+        Node* node = graph->list[i];
+
+        for(size_t j = 0; j < node->count; j++) {
+
+            Node* dependency = node->dependencies[j];
+            dependency->dependents[dependency->dependent_count++] = node;
+        }
+    }
 }
 
-bool cycles_exist(Node* root) {
+// kahn's algorithm. a node is ready once all of its dependencies are, nodes on or behind a cycle never are.
+void schedule_graph(Graph* graph) {
 
-    VisitedNodes visited = {0};
-    Recstack recstack = {0};
+    build_dependents(graph);
 
-    for(size_t i = 0; i < root->count; i++) {
+    graph->order = arena_alloc(graph->arena, sizeof(Node*) * (graph->count + 1));
+    graph->order_count = 0;
 
-        if(!was_visited(root->dependencies[i], &visited)) {
+    for(size_t i = 0; i < graph->count; i++) {
 
-            if(dfs_cycle(root->dependencies[i], &visited, &recstack)) {
+        graph->list[i]->pending = graph->list[i]->count;
+        if(graph->list[i]->pending == 0) graph->order[graph->order_count++] = graph->list[i];
+    }
 
-                report_cycle(&recstack);
-                return true;
-            }
+    //the order doubles as the queue, everything before `next` has been processed
+    for(size_t next = 0; next < graph->order_count; next++) {
+
+        Node* node = graph->order[next];
+
+        for(size_t i = 0; i < node->dependent_count; i++) {
+
+            Node* dependent = node->dependents[i];
+            if(--dependent->pending == 0) graph->order[graph->order_count++] = dependent;
         }
     }
 
-    return false;
-}
\ No newline at end of file
+    for(size_t i = 0; i < graph->order_count; i++) graph->order[i]->rank = i;
+
+    //whatever never got ready is behind a cycle, recalculations have to leave it alone too
+    for(size_t i = 0; i < graph->count; i++) {
+
+        if(graph->list[i]->pending > 0) graph->list[i]->cyclic = true;
+    }
+}
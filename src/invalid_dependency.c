@@ -6,45 +6,42 @@
 #include "invalid_dependency.h"
 
 
-void report_invalid_dependency(Recstack* recstack, Cell* target_cell, const char* err_message) {
+void report_invalid_dependency(Table* table, Recstack* recstack, const Cell* target_cell, const char* err_message) {
 
-    char buffer[INVALID_DEPENDENCY_BUFFER_SIZE];
-    memset(buffer, '\0', sizeof(buffer));
-    size_t iterator = 0;
+    char name[COLUMN_NAME_SIZE];
+    Node* target = recstack->nodes[recstack->count - 1];
 
-    iterator += sprintf(buffer + iterator, ANSI_RED "%s" ANSI_RESET, err_message);
+    printf(ANSI_RED "%s" ANSI_RESET, err_message);
     for(size_t i = 0; i < recstack->count - 1; i++) {
 
-        iterator += sprintf(buffer + iterator, "%c%d -> ", 'A' + recstack->nodes[i]->col, recstack->nodes[i]->row);
+        printf("%s%d -> ", column_name(recstack->nodes[i]->col, name), recstack->nodes[i]->row);
     }
 
-    switch(target_cell->kind) {
+    column_name(target->col, name);
+
+    switch(cell_kind(target_cell)) {
 
         case KIND_EXPR: {
 
-            sprintf(buffer + iterator, "( %c%d = '"SSFormat"')\n",
-            'A' + recstack->nodes[recstack->count - 1]->col, recstack->nodes[recstack->count - 1]->row, SSArg(target_cell->as.expression.expr));
+            printf("( %s%d = '"SSFormat"')\n", name, target->row, SSArg(cell_text(table, target_cell)));
             break;
         }
 
         case KIND_TEXT: {
 
-            sprintf(buffer + iterator, "( %c%d = '"SSFormat"')\n",
-            'A' + recstack->nodes[recstack->count - 1]->col, recstack->nodes[recstack->count - 1]->row, SSArg(target_cell->as.text));
+            printf("( %s%d = '"SSFormat"')\n", name, target->row, SSArg(cell_text(table, target_cell)));
             break;
         }
 
         case KIND_EMPTY: {
 
-            sprintf(buffer + iterator, "( %c%d = '"SSFormat"')\n",
-            'A' + recstack->nodes[recstack->count - 1]->col, recstack->nodes[recstack->count - 1]->row, SSArg(target_cell->as.text));
+            printf("( %s%d = '"SSFormat"')\n", name, target->row, SSArg(cell_text(table, target_cell)));
             break;
         }
 
         case KIND_COLOUR: {
 
-            sprintf(buffer + iterator, "( %c%d, which is a COLOUR)\n",
-            'A' + recstack->nodes[recstack->count - 1]->col, recstack->nodes[recstack->count - 1]->row);
+            printf("( %s%d, which is a COLOUR)\n", name, target->row);
             break;
         }
 
@@ -53,54 +50,49 @@ void report_invalid_dependency(Recstack* recstack, Cell* target_cell, const char
             assert(0 && "Unreachable code.");
         }
     }
-    
-    printf("%s", buffer);
 }
 
-bool dfs_invalid_dependency(Table* table, Node* root, VisitedNodes* visited, Recstack* recstack) {
-
-    assert(root != NULL);
+// reports the last node of the path if expressions can't depend on it
+static bool invalid_target(Table* table, Recstack* recstack) {
 
-    push_stack(visited, root);
-    push_stack(recstack, root);
+    Node* target = recstack->nodes[recstack->count - 1];
 
-    //check if current node is valid
-    Cell* target_cell = cell_at(table, root->row, root->col);
+    const Cell* target_cell = cell_at(table, target->row, target->col);
     assert(target_cell != NULL);
 
-    switch(target_cell->kind) {
+    switch(cell_kind(target_cell)) {
 
         case KIND_NUM: {
             
-            break;
+            return false;
         }
 
         case KIND_EXPR: {
 
-            if(target_cell->as.expression.kind == EXPR_INVALID) { //report cells who cant depend on an invalid cell
+            if(cell_expr_kind(target_cell) == EXPR_INVALID) { //report cells who cant depend on an invalid cell
 
-                report_invalid_dependency(recstack, target_cell, "[DEPCHK] Expressions depend on an invalid expression cell.\n");
+                report_invalid_dependency(table, recstack, target_cell, "[DEPCHK] Expressions depend on an invalid expression cell.\n");
                 return true;
             }
             
-            break;
+            return false;
         }
 
         case KIND_TEXT: { //report that cells cant depend on a cell which is a string
 
-            report_invalid_dependency(recstack, target_cell, "[DEPCHK] Expressions depend on a text cell.\n");
+            report_invalid_dependency(table, recstack, target_cell, "[DEPCHK] Expressions depend on a text cell.\n");
             return true;
         }
 
         case KIND_EMPTY: { //report that cells cant depend on an empty cell
 
-            report_invalid_dependency(recstack, target_cell, "[DEPCHK] Expressions depend on an empty cell.\n");
+            report_invalid_dependency(table, recstack, target_cell, "[DEPCHK] Expressions depend on an empty cell.\n");
             return true;
         }
 
         case KIND_COLOUR: {
 
-            report_invalid_dependency(recstack, target_cell, "[DEPCHK] Expressions depend on a coloured cell.\n");
+            report_invalid_dependency(table, recstack, target_cell, "[DEPCHK] Expressions depend on a coloured cell.\n");
             return true;
         }
 
@@ -109,31 +101,63 @@ bool dfs_invalid_dependency(Table* table, Node* root, VisitedNodes* visited, Rec
             assert(0 && "Unreachable code.");
         }
     }
+}
 
-    for(size_t i = 0; i < root->count; i++) {
+// depth first with an explicit stack, chains of dependencies can be as long as the table. the path is kept in recstack
+// so a report can show how the expression got there, next holds the dependency each node of the path is at
+bool dfs_invalid_dependency(Table* table, Node* root, VisitedNodes* visited, Recstack* recstack, size_t* next) {
+
+    assert(root != NULL);
+
+    mark_visited(root, visited);
+    push_stack(recstack, root);
+    next[0] = 0;
 
-        if(dfs_invalid_dependency(table, root->dependencies[i], visited, recstack)) return true;
+    if(invalid_target(table, recstack)) return true;
+
+    while(recstack->count > 0) {
+
+        size_t depth = recstack->count - 1;
+        Node* node = recstack->nodes[depth];
+
+        if(next[depth] == node->count) { //every dependency checked
+
+            pop_stack(recstack);
+            continue;
+        }
+
+        Node* dependency = node->dependencies[next[depth]++];
+        if(was_visited(dependency, visited)) continue; //already checked through another path
+
+        mark_visited(dependency, visited);
+        push_stack(recstack, dependency);
+        next[depth + 1] = 0;
+
+        if(invalid_target(table, recstack)) return true;
     }
 
-    pop_stack(recstack);
     return false;
 }
 
-bool invalid_dependencies_exist(Table* table, Node* root) {
+bool invalid_dependencies_exist(Table* table, Graph* graph) {
 
-    VisitedNodes visited = {0};
-    Recstack recstack = {0};
+    Node* root = graph->root;
+    VisitedNodes visited = make_visited(graph->scratch, graph->count);
+    Recstack recstack = make_recstack(graph->scratch, graph->count);
+    size_t* next = arena_alloc(graph->scratch, sizeof(size_t) * (graph->count + 1));
+    bool found = false;
 
     for(size_t i = 0; i < root->count; i++) {
 
         if(!was_visited(root->dependencies[i], &visited)) {
 
-            if(dfs_invalid_dependency(table, root->dependencies[i], &visited, &recstack)) {
+            if(dfs_invalid_dependency(table, root->dependencies[i], &visited, &recstack, next)) {
                 
-                return true;
+                found = true;
+                break;
             }
         }
     }
 
-    return false;
-}
\ No newline at end of file
+    return found;
+}
@@ -3,19 +3,21 @@
 #include <string.h>
 #include <assert.h>
 #include <math.h>
+#include <unistd.h>
 
 #include "ss.h"
 #include "menu.h"
 
-/*
-    TODO
-
-        implement an arena for storing pointers to memory occupied by newly created values that replace table cell values.
-        now its a memory leak.
-*/
+extern int solve_thread_count;
 
 int main(int argc, char* argv[]) {
 
+    if(argc == 3 && strcmp(argv[1], "-j") == 0) {
+
+        solve_thread_count = atoi(argv[2]);
+        if(solve_thread_count <= 0) solve_thread_count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+
     show_menu();
     return 0;
 }
\ No newline at end of file
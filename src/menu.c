@@ -2,16 +2,17 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <sys/mman.h>
 
 #include "table.h"
+#include "columns.h"
+#include "colour_layer.h"
 #include "constants.h"
 #include "equation_solver.h"
+#include "parallel_solver.h"
 
 
 
-extern int max_cell_width;
-extern int expression_count;
-
 void print_menu_options() {
     
     printf("\n\n\n----------------------------------\nChoose an option:\n");
@@ -26,24 +27,29 @@ void print_menu_options() {
 
 void free_table(Table* table) {
 
-    free(table->cells);
+    invalidate_solve(table);
+    arena_free(&table->arena);
+    arena_free(&table->scratch);
+    pool_free(&table->strings);
+    free_colours(table); //before free_tiles, which forgets how many blocks of rows there are
+    free_tiles(table);
+
+    if(table->mapping != NULL) munmap(table->mapping, table->mapping_size);
+    table->mapping = NULL;
+    table->expression_count = 0;
+    table->rows = 0; //nothing is left to index into
+    table->cols = 0;
 }
 
-void handle_import(Table* table, char* loaded_content, bool* loaded_table) {
+void handle_import(Table* table, bool* loaded_table) {
 
     if(*loaded_table) {
 
-        free(table->cells);
+        free_table(table);
         printf(ANSI_YELLOW "Freed memory used by prior table." ANSI_RESET "\n");
         *loaded_table = false;
     }
 
-    if(loaded_content) {
-
-        free(loaded_content);
-        loaded_content = NULL;
-    }
-
     printf("Enter the name of the input file, including its extension.\n> ");
 
     char input_file_name[128];
@@ -54,47 +60,48 @@ void handle_import(Table* table, char* loaded_content, bool* loaded_table) {
     while(input_file_name[new_line] != '\n') new_line++;
     input_file_name[new_line] = '\0';
 
-    int len = 0;
-    loaded_content = consume_file(input_file_name, &len);
+    switch(import_table(table, input_file_name)) {
 
-    if(loaded_content == NULL) {
+        case IMPORT_OK: break;
 
-        printf("Couldn't find that file.\n");
-        return;
-    }
+        case IMPORT_NOT_FOUND: {
 
-    StringStruct input = ss_form_string(loaded_content, len);
+            printf("Couldn't find that file.\n");
+            return;
+        }
 
-    int rows;
-    int cols;
+        case IMPORT_TOO_LARGE: {
 
-    approx_table_size(input, &rows, &cols);
+            printf(ANSI_RED "[ERROR] This program only supports files smaller than 4 GiB." ANSI_RESET "\n");
+            return;
+        }
 
-    if(cols > 26) printf("[ERROR] This program only supports up to 26 columns.\n");
-    assert(cols <= 26);
-    if(rows > 999) printf("[ERROR] This program only supports up to 999 rows.\n");
-    assert(rows <= 999);
+        case IMPORT_TOO_MANY_ROWS: {
 
-    *table = alloc_table(rows, cols);
+            printf("[ERROR] This program only supports up to %d rows.\n", TABLE_MAX_ROWS);
+            return;
+        }
+
+        case IMPORT_TOO_MANY_COLS: {
+
+            printf("[ERROR] This program only supports up to %d columns.\n", TABLE_MAX_COLS);
+            return;
+        }
+    }
 
-    populate_table(table, input);
     print_table(table, stdout);
 
     *loaded_table = true;
     printf(ANSI_GREEN "Table loaded successfully." ANSI_RESET "\n");
 }
 
-void handle_create(Table* table, char* loaded_content, bool* loaded_table) {
+void handle_create(Table* table, bool* loaded_table) {
 
     if(*loaded_table) {
 
-        free(table->cells);
+        free_table(table);
         printf(ANSI_YELLOW "Freed memory used by prior table." ANSI_RESET "\n");
-    }
-
-    if(loaded_content) {
-        free(loaded_content);
-        loaded_content = NULL;
+        *loaded_table = false;
     }
 
     printf("Specify dimensions of the custom table. Expected format: <columns> <rows>.\n> ");
@@ -127,10 +134,17 @@ void handle_create(Table* table, char* loaded_content, bool* loaded_table) {
         return;
     }
 
-    if(cols > 26) printf("[ERROR] This program only supports up to 26 columns.\n");
-    assert(cols <= 26);
-    if(rows > 999) printf("[ERROR] This program only supports up to 999 rows.\n");
-    assert(rows <= 999);
+    if(cols > TABLE_MAX_COLS) {
+
+        printf("[ERROR] This program only supports up to %d columns.\n", TABLE_MAX_COLS);
+        return;
+    }
+
+    if(rows > TABLE_MAX_ROWS) {
+
+        printf("[ERROR] This program only supports up to %d rows.\n", TABLE_MAX_ROWS);
+        return;
+    }
 
     *table = alloc_table(rows, cols);
 
@@ -150,11 +164,11 @@ void handle_modify(Table* table, bool* loaded_table) {
 
     printf("Name a cell you want to change.\n> ");
 
-    char cell_ref_buffer[8];
+    char cell_ref_buffer[CELL_NAME_SIZE];
     memset(cell_ref_buffer, '\0', sizeof(cell_ref_buffer));
     fgets(cell_ref_buffer, sizeof(cell_ref_buffer), stdin);
 
-    for(size_t i = 0; i < 8; i++) {
+    for(size_t i = 0; i < sizeof(cell_ref_buffer); i++) {
 
         if(cell_ref_buffer[i] == '\n') {
 
@@ -188,50 +202,19 @@ void handle_modify(Table* table, bool* loaded_table) {
         }
     }
 
-    char* new_value = malloc(sizeof(char) * 64); //MEMORY LEAK
-    memset(new_value, '\0', 64);
-    memcpy(new_value, _new_value, 64);
-
-
-    //find out what type it is and update its fields in the table
-    StringStruct token = ss_form_string_nt(new_value);
-    StringStruct colour = SS("");
+    //find out what type it is and update its fields in the table, text is copied into the table's string pool
+    StringStruct token = ss_form_string_nt(_new_value);
     printf(SSFormat"\n", SSArg(token));
 
-    if(is_colour(token, &colour)) {
+    CellKind kind = fill_cell(table, row, col, token, &table->strings);
 
-        cell_at(table, row, col)->kind = KIND_COLOUR;
-        cell_at(table, row, col)->as.colour = colour;
-    }
-    else if(ss_starts_with(&token, '=')) {
-
-        if(token.count > max_cell_width) max_cell_width = token.count;
-
-        cell_at(table, row, col)->as.expression.expr = token;
-        cell_at(table, row, col)->as.expression.kind = EXPR_DEFAULT;
-        cell_at(table, row, col)->kind = KIND_EXPR;
-        expression_count++;
-                    
-    } else if(ss_isnumber(token)) {
-
-        if(token.count > max_cell_width) max_cell_width = token.count;
-
-        cell_at(table, row, col)->as.number = ss_tod(token);
-        cell_at(table, row, col)->kind = KIND_NUM;
-    } else {
-
-        if(token.count > max_cell_width) max_cell_width = token.count;
-
-        cell_at(table, row, col)->as.text = token;
-        if(token.count == 0)
-            cell_at(table, row, col)->kind = KIND_EMPTY;
-        else
-            cell_at(table, row, col)->kind = KIND_TEXT;
-    }
+    if(kind == KIND_EXPR) table->expression_count++;
 
     printf(ANSI_GREEN "Cell modified successfully." ANSI_RESET "\n");
 
-    calculate_new_cell_width(table);
+    recalculate_cell(table, row, col); //keeps the last solve up to date, or drops it if the structure changed
+    refresh_width(table, row, col); //its dependents were refreshed as they were recalculated
+
     print_table(table, stdout);
 }
 
@@ -288,7 +271,6 @@ void show_menu() {
     
     char option = '0';
     Table table = {0};
-    char* loaded_content = NULL;
     bool loaded_table = false;
 
     while(true) {
@@ -303,13 +285,13 @@ void show_menu() {
 
             case '1': {
 
-                handle_import(&table, loaded_content, &loaded_table);
+                handle_import(&table, &loaded_table);
                 break;
             }
 
             case '2': {
 
-                handle_create(&table, loaded_content, &loaded_table);
+                handle_create(&table, &loaded_table);
                 break;
             }
 
@@ -333,8 +315,8 @@ void show_menu() {
 
             case '6': {
                 
-                if(table.cells != NULL) free(table.cells);
-                if(loaded_content != NULL) free(loaded_content);
+                free_table(&table); //also releases arenas of a solve that ran without a table
+                stop_solve_workers();
                 return;
             }
 
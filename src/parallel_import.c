@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "parallel_import.h"
+#include "table.h"
+
+void* index_worker(void* arg) {
+
+    ImportWorker* worker = arg;
+    index_chunk(worker->chunk);
+
+    return NULL;
+}
+
+void* populate_worker(void* arg) {
+
+    ImportWorker* worker = arg;
+    populate_chunk(worker->table, worker->chunk);
+
+    return NULL;
+}
+
+// cuts the input into about equally sized chunks that end right after a newline. returns how many there are
+int split_input(StringStruct input, ImportChunk* chunks, int count) {
+
+    int chunk_count = 0;
+    size_t start = 0;
+
+    for(int i = 1; i <= count && start < input.count; i++) {
+
+        size_t end = input.count * i / count;
+        if(end < start) end = start;
+
+        const char* newline = i == count ? NULL : memchr(input.data + end, '\n', input.count - end);
+        end = newline != NULL ? (size_t)(newline - input.data) + 1 : input.count;
+
+        memset(&chunks[chunk_count], 0, sizeof(ImportChunk));
+        chunks[chunk_count++].input = ss_form_string((char*)input.data + start, end - start);
+
+        start = end;
+    }
+
+    return chunk_count;
+}
+
+static void run_workers(ImportWorker* workers, int count, void* (*routine)(void*)) {
+
+    pthread_t threads[count];
+
+    for(int i = 0; i < count; i++) {
+
+        int ret = pthread_create(&threads[i], NULL, routine, &workers[i]);
+        assert(ret == 0);
+    }
+
+    for(int i = 0; i < count; i++) {
+
+        pthread_join(threads[i], NULL);
+    }
+}
+
+// indexes the chunks in parallel, sizes the table once from their row and column counts and then fills their rows in parallel
+ImportStatus populate_table_parallel(Table* table, StringStruct input, int thread_count) {
+
+    assert(thread_count > 1);
+
+    ImportChunk chunks[thread_count];
+    ImportWorker workers[thread_count];
+
+    int chunk_count = split_input(input, chunks, thread_count);
+
+    for(int i = 0; i < chunk_count; i++) {
+
+        workers[i].table = table;
+        workers[i].chunk = &chunks[i];
+    }
+
+    run_workers(workers, chunk_count, index_worker);
+
+    int rows = table->rows;
+    int cols = 0;
+
+    for(int i = 0; i < chunk_count; i++) {
+
+        chunks[i].first_row = rows;
+        rows += chunks[i].rows;
+        if(chunks[i].cols > cols) cols = chunks[i].cols;
+    }
+
+    ImportStatus status = check_dimensions(rows, cols);
+
+    if(status != IMPORT_OK) { //nothing is reserved until the counts are known to fit
+
+        for(int i = 0; i < chunk_count; i++) free_structural_index(&chunks[i].index);
+        return status;
+    }
+
+    reserve_table(table, rows, cols);
+    table->rows = rows;
+
+    run_workers(workers, chunk_count, populate_worker);
+
+    merge_chunks(table, chunks, chunk_count);
+    return IMPORT_OK;
+}
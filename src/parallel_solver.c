@@ -0,0 +1,240 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "parallel_solver.h"
+#include "equation_solver.h"
+#include "graph.h"
+#include "table.h"
+
+void work_queue_push(WorkQueue* queue, Node* node) {
+
+    pthread_mutex_lock(&queue->lock);
+    queue->nodes[queue->bottom++] = node;
+    pthread_mutex_unlock(&queue->lock);
+}
+
+Node* work_queue_pop(WorkQueue* queue) {
+
+    Node* node = NULL;
+
+    pthread_mutex_lock(&queue->lock);
+    if(queue->bottom > queue->top) node = queue->nodes[--queue->bottom];
+    pthread_mutex_unlock(&queue->lock);
+
+    return node;
+}
+
+Node* work_queue_steal(WorkQueue* queue) {
+
+    Node* node = NULL;
+
+    pthread_mutex_lock(&queue->lock);
+    if(queue->bottom > queue->top) node = queue->nodes[queue->top++];
+    pthread_mutex_unlock(&queue->lock);
+
+    return node;
+}
+
+static WorkPool solve_pool = {0}; //started by the first parallel solve, stopped when the program exits
+
+static Node* take_node(WorkPool* pool, int id) {
+
+    Node* node = work_queue_pop(&pool->queues[id]);
+
+    for(int i = 1; node == NULL && i < pool->worker_count; i++) {
+
+        node = work_queue_steal(&pool->queues[(id + i) % pool->worker_count]);
+    }
+
+    if(node != NULL) __atomic_sub_fetch(&pool->available, 1, __ATOMIC_SEQ_CST);
+
+    return node;
+}
+
+static void queue_node(WorkPool* pool, WorkQueue* queue, Node* node) {
+
+    __atomic_add_fetch(&pool->available, 1, __ATOMIC_SEQ_CST);
+    work_queue_push(queue, node);
+
+    //a worker counts itself as sleeping before it looks at available, so either it sees this node or it gets woken
+    if(__atomic_load_n(&pool->sleeping, __ATOMIC_SEQ_CST) > 0) {
+
+        pthread_mutex_lock(&pool->lock);
+        pthread_cond_signal(&pool->ready);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+// blocks until a node is queued or the last one is evaluated
+static void wait_for_node(WorkPool* pool) {
+
+    pthread_mutex_lock(&pool->lock);
+    __atomic_add_fetch(&pool->sleeping, 1, __ATOMIC_SEQ_CST);
+
+    while(__atomic_load_n(&pool->available, __ATOMIC_SEQ_CST) == 0 && __atomic_load_n(&pool->remaining, __ATOMIC_SEQ_CST) > 0) {
+
+        pthread_cond_wait(&pool->ready, &pool->lock);
+    }
+
+    __atomic_sub_fetch(&pool->sleeping, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void solve_nodes(WorkPool* pool, int id) {
+
+    WorkQueue* own = &pool->queues[id];
+
+    while(__atomic_load_n(&pool->remaining, __ATOMIC_SEQ_CST) > 0) {
+
+        Node* node = take_node(pool, id);
+
+        if(node == NULL) { //everything ready is being worked on, sleep until more is
+
+            wait_for_node(pool);
+            continue;
+        }
+
+        solve_expression(pool->table, node);
+
+        //a dependent is ready once its last dependency finishes, whoever finishes it queues it
+        for(size_t i = 0; i < node->dependent_count; i++) {
+
+            Node* dependent = node->dependents[i];
+            if(__atomic_sub_fetch(&dependent->pending, 1, __ATOMIC_ACQ_REL) == 0) queue_node(pool, own, dependent);
+        }
+
+        if(__atomic_sub_fetch(&pool->remaining, 1, __ATOMIC_SEQ_CST) == 0) { //the solve is over, nobody should keep sleeping
+
+            pthread_mutex_lock(&pool->lock);
+            pthread_cond_broadcast(&pool->ready);
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+}
+
+void* solve_worker(void* arg) {
+
+    Worker* worker = arg;
+    WorkPool* pool = worker->pool;
+    size_t seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+
+    while(true) {
+
+        while(pool->generation == seen && !pool->stopping) pthread_cond_wait(&pool->start, &pool->lock);
+        if(pool->stopping) break;
+
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        solve_nodes(pool, worker->id);
+
+        pthread_mutex_lock(&pool->lock);
+        if(--pool->busy == 0) pthread_cond_signal(&pool->done);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+static void start_solve_workers(WorkPool* pool, int thread_count) {
+
+    pool->worker_count = thread_count;
+    pool->threads = malloc(sizeof(pthread_t) * thread_count);
+    pool->workers = malloc(sizeof(Worker) * thread_count);
+    assert(pool->threads != NULL && pool->workers != NULL);
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->ready, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    for(int i = 0; i < thread_count; i++) {
+
+        pool->workers[i].pool = pool;
+        pool->workers[i].id = i;
+
+        int ret = pthread_create(&pool->threads[i], NULL, solve_worker, &pool->workers[i]);
+        assert(ret == 0);
+    }
+}
+
+void stop_solve_workers(void) {
+
+    WorkPool* pool = &solve_pool;
+    if(pool->threads == NULL) return; //no parallel solve ever ran
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    for(int i = 0; i < pool->worker_count; i++) {
+
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->ready);
+    pthread_cond_destroy(&pool->done);
+    free(pool->threads);
+    free(pool->workers);
+
+    *pool = (WorkPool){0};
+}
+
+// evaluates the same cells as solve_expressions with the same formulas, so the results are identical
+void solve_expressions_parallel(Table* table, Graph* graph, int thread_count) {
+
+    assert(thread_count > 1);
+
+    WorkPool* pool = &solve_pool;
+    if(pool->threads == NULL) start_solve_workers(pool, thread_count);
+    assert(pool->worker_count == thread_count);
+
+    //the workers are all waiting for the next solve, so nothing below races with them
+    pool->table = table;
+    pool->remaining = graph->order_count;
+    pool->available = 0;
+    pool->queues = arena_alloc(graph->scratch, sizeof(WorkQueue) * thread_count);
+
+    for(int i = 0; i < thread_count; i++) {
+
+        //every node is pushed once in total, so no queue can ever hold more than all of them
+        pool->queues[i].nodes = arena_alloc(graph->scratch, sizeof(Node*) * (graph->order_count + 1));
+        pool->queues[i].top = 0;
+        pool->queues[i].bottom = 0;
+        pthread_mutex_init(&pool->queues[i].lock, NULL);
+    }
+
+    int seeded = 0;
+    for(size_t i = 0; i < graph->count; i++) {
+
+        Node* node = graph->list[i];
+        node->pending = node->count;
+
+        if(node->pending == 0) {
+
+            work_queue_push(&pool->queues[seeded++ % thread_count], node);
+            pool->available++;
+        }
+    }
+
+    pthread_mutex_lock(&pool->lock);
+
+    pool->busy = thread_count;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+
+    while(pool->busy > 0) pthread_cond_wait(&pool->done, &pool->lock);
+
+    pthread_mutex_unlock(&pool->lock);
+
+    for(int i = 0; i < thread_count; i++) {
+
+        pthread_mutex_destroy(&pool->queues[i].lock);
+    }
+}
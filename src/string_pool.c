@@ -0,0 +1,114 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "string_pool.h"
+
+// FNV-1a, strings are short and this runs once per edit
+static uint64_t hash_string(const char* string, size_t length) {
+
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for(size_t i = 0; i < length; i++) {
+
+        hash ^= (unsigned char)string[i];
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+static size_t find_slot(StringPool* pool, const char* string, size_t length, uint64_t hash) {
+
+    size_t mask = pool->slot_count - 1;
+    size_t slot = hash & mask;
+
+    while(pool->slots[slot] != 0) {
+
+        PoolEntry* entry = &pool->entries[pool->slots[slot] - 1];
+        if(entry->length == length && memcmp(pool->data + entry->offset, string, length) == 0) break;
+
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+static void grow_slots(StringPool* pool) {
+
+    size_t slot_count = pool->slot_count > 0 ? pool->slot_count * 2 : STRING_POOL_INITIAL_SLOTS;
+    uint32_t* slots = calloc(slot_count, sizeof(uint32_t));
+    assert(slots != NULL);
+
+    uint32_t* old_slots = pool->slots;
+    size_t old_count = pool->slot_count;
+
+    pool->slots = slots;
+    pool->slot_count = slot_count;
+
+    for(size_t i = 0; i < old_count; i++) {
+
+        if(old_slots[i] == 0) continue;
+
+        PoolEntry* entry = &pool->entries[old_slots[i] - 1];
+        const char* string = pool->data + entry->offset;
+
+        slots[find_slot(pool, string, entry->length, hash_string(string, entry->length))] = old_slots[i];
+    }
+
+    free(old_slots);
+}
+
+// id of the string, storing it first if the pool hasn't seen it yet
+uint32_t pool_intern(StringPool* pool, const char* string, size_t length) {
+
+    if((pool->count + 1) * 2 > pool->slot_count) grow_slots(pool); //stays under half full
+
+    uint64_t hash = hash_string(string, length);
+    size_t slot = find_slot(pool, string, length, hash);
+
+    if(pool->slots[slot] != 0) return pool->slots[slot] - 1;
+
+    assert(pool->size + length <= UINT32_MAX && pool->count < UINT32_MAX);
+
+    if(pool->size + length > pool->capacity) {
+
+        size_t capacity = pool->capacity > 0 ? pool->capacity : 256;
+        while(pool->size + length > capacity) capacity *= 2;
+
+        pool->data = realloc(pool->data, capacity);
+        assert(pool->data != NULL);
+        pool->capacity = capacity;
+    }
+
+    if(pool->count == pool->entry_capacity) {
+
+        pool->entry_capacity = pool->entry_capacity > 0 ? pool->entry_capacity * 2 : 16;
+        pool->entries = realloc(pool->entries, sizeof(PoolEntry) * pool->entry_capacity);
+        assert(pool->entries != NULL);
+    }
+
+    memcpy(pool->data + pool->size, string, length);
+
+    pool->entries[pool->count] = (PoolEntry){ .offset = (uint32_t)pool->size, .length = (uint32_t)length };
+    pool->size += length;
+    pool->slots[slot] = ++pool->count;
+
+    return pool->count - 1;
+}
+
+// the string stays valid until the next string is added to the pool
+StringStruct pool_string(StringPool* pool, uint32_t id) {
+
+    assert(id < pool->count);
+    return ss_form_string(pool->data + pool->entries[id].offset, pool->entries[id].length);
+}
+
+void pool_free(StringPool* pool) {
+
+    free(pool->data);
+    free(pool->entries);
+    free(pool->slots);
+
+    *pool = (StringPool){0};
+}
@@ -0,0 +1,99 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define STRUCTURAL_BLOCK 32
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define STRUCTURAL_BLOCK 16
+#else
+#define STRUCTURAL_BLOCK 8
+#endif
+
+#include "structural.h"
+
+static void reserve_offsets(StructuralIndex* index, size_t count) {
+
+    if(index->count + count <= index->capacity) return;
+
+    while(index->count + count > index->capacity) index->capacity *= 2;
+
+    index->offsets = realloc(index->offsets, sizeof(size_t) * index->capacity);
+    assert(index->offsets != NULL);
+}
+
+// one bit per byte of the block, set where the byte is a delimiter
+static uint32_t block_mask(const char* block) {
+
+#if defined(__AVX2__)
+
+    __m256i bytes = _mm256_loadu_si256((const __m256i*)block);
+    __m256i rows = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n'));
+    __m256i cells = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('|'));
+
+    return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(rows, cells));
+
+#elif defined(__SSE2__)
+
+    __m128i bytes = _mm_loadu_si128((const __m128i*)block);
+    __m128i rows = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n'));
+    __m128i cells = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('|'));
+
+    return (uint32_t)_mm_movemask_epi8(_mm_or_si128(rows, cells));
+
+#else
+
+    uint32_t mask = 0;
+    for(int i = 0; i < STRUCTURAL_BLOCK; i++) {
+
+        if(block[i] == '\n' || block[i] == '|') mask |= (uint32_t)1 << i;
+    }
+
+    return mask;
+
+#endif
+}
+
+// finds every delimiter a block at a time, bytes that aren't delimiters never take a branch
+StructuralIndex build_structural_index(const char* data, size_t size) {
+
+    StructuralIndex index = {0};
+    index.capacity = STRUCTURAL_INITIAL_SIZE;
+    index.offsets = malloc(sizeof(size_t) * index.capacity);
+    assert(index.offsets != NULL);
+
+    size_t i = 0;
+
+    for(; i + STRUCTURAL_BLOCK <= size; i += STRUCTURAL_BLOCK) {
+
+        uint32_t mask = block_mask(data + i);
+        if(mask == 0) continue;
+
+        reserve_offsets(&index, STRUCTURAL_BLOCK);
+
+        while(mask != 0) {
+
+            index.offsets[index.count++] = i + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+
+    reserve_offsets(&index, STRUCTURAL_BLOCK);
+
+    for(; i < size; i++) { //tail shorter than a block
+
+        if(data[i] == '\n' || data[i] == '|') index.offsets[index.count++] = i;
+    }
+
+    return index;
+}
+
+void free_structural_index(StructuralIndex* index) {
+
+    free(index->offsets);
+    index->offsets = NULL;
+    index->count = 0;
+    index->capacity = 0;
+}
@@ -2,186 +2,316 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "table.h"
 #include "constants.h"
+#include "classify.h"
+#include "columns.h"
+#include "format.h"
+#include "writer.h"
+#include "colour_layer.h"
+#include "structural.h"
+#include "parallel_import.h"
 
-int max_cell_width = 3;
-int expression_count = 0; //for dynamic allocation of graph nodes later
 
+extern int solve_thread_count;
 
-char* consume_file(const char* input_file_path, int* count) {
 
+// maps the file and reads it into a table in one pass. cells point straight into the mapping, it lives as long as the table
+ImportStatus import_table(Table* table, const char* input_file_path) {
 
-    char* buffer = NULL;
-    int len = 0;
+    int fd = open(input_file_path, O_RDONLY);
+    if(fd < 0) return IMPORT_NOT_FOUND;
 
-    FILE* file = fopen(input_file_path, "rb");
+    struct stat info;
+    if(fstat(fd, &info) < 0) {
 
-    if(file == NULL) goto end;
+        close(fd);
+        return IMPORT_NOT_FOUND;
+    }
 
-    if(fseek(file, 0, SEEK_END) < 0) goto end;
+    if((uint64_t)info.st_size > UINT32_MAX) { //checked before mapping, so there's nothing to undo
 
-    len = ftell(file);
-    
-    if(len < 0) goto end;
+        close(fd);
+        return IMPORT_TOO_LARGE;
+    }
+
+    Table imported = {0};
+
+    if(info.st_size > 0) {
+
+        imported.mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(imported.mapping == MAP_FAILED) {
+
+            close(fd);
+            return IMPORT_NOT_FOUND;
+        }
+
+        imported.mapping_size = info.st_size;
+        madvise(imported.mapping, imported.mapping_size, MADV_SEQUENTIAL);
+    }
+
+    close(fd); //the mapping stays valid without it
+
+    ImportStatus status = populate_table(&imported, ss_form_string(imported.mapping, imported.mapping_size));
+
+    if(status != IMPORT_OK) { //whatever was filled before the limit was hit goes with the mapping
 
-    buffer = malloc(sizeof(char) * len);
+        free_colours(&imported);
+        free_tiles(&imported);
+        pool_free(&imported.strings);
+        if(imported.mapping != NULL) munmap(imported.mapping, imported.mapping_size);
 
-    if(buffer == NULL) goto end;
+        return status;
+    }
 
-    if(fseek(file, 0, SEEK_SET) < 0) goto end;
+    count_widths(&imported);
 
-    size_t read = fread(buffer, sizeof(char), len, file);
-    assert(read == len);
+    *table = imported;
+    return IMPORT_OK;
+}
 
-    if(count)
-        *count = len;
+static Cell empty_cell = {0}; // what cell_at gives for cells of tiles that don't exist, never written to
+static Cell colour_cell = { .box = (uint64_t)KIND_COLOUR << CELL_KIND_SHIFT }; // what cell_at gives for every coloured cell
 
-    return buffer;
+Table alloc_table(int rows, int cols) {
 
-    end:
-        if(file) fclose(file);
-        if(buffer) free(buffer);
+    Table table = {0};
+    reserve_table(&table, rows, cols);
+    table.rows = rows;
 
-        return NULL;
+    return table;
 }
 
-void approx_table_size(StringStruct input, int* out_rows, int* out_cols) {
+// makes room for at least rows x cols cells. only the tile directory grows, rows of it geometrically, tiles stay where they are
+void reserve_table(Table* table, int rows, int cols) {
 
-    int max_rows = 0;
-    int max_cols = 0;
+    int tile_rows = (rows + TILE_SIZE - 1) >> TILE_SHIFT;
+    int tile_cols = (cols + TILE_SIZE - 1) >> TILE_SHIFT;
 
-    while(input.count > 0) {
+    if(cols > table->cols) table->cols = cols;
 
-        max_rows++;
+    if(tile_rows <= table->tile_rows && tile_cols <= table->tile_cols) return;
 
-        StringStruct line = ss_cut_by_delim(&input, '\n');
+    if(tile_rows > table->tile_rows && tile_rows < table->tile_rows * 2) tile_rows = table->tile_rows * 2;
+    if(tile_rows < table->tile_rows) tile_rows = table->tile_rows;
+    if(tile_cols < table->tile_cols) tile_cols = table->tile_cols;
 
-        int cols = 0;
+    Tile** tiles = calloc((size_t)tile_rows * tile_cols > 0 ? (size_t)tile_rows * tile_cols : 1, sizeof(Tile*));
+    assert(tiles != NULL);
 
-        while(line.count > 0) {
+    for(int tile_row = 0; tile_row < table->tile_rows; tile_row++) {
 
-            StringStruct cell_in_row = ss_cut_by_delim(&line, '|');
-            cols++;
-        }
+        for(int tile_col = 0; tile_col < table->tile_cols; tile_col++) {
 
-        if(max_cols < cols) max_cols = cols;
+            tiles[(size_t)tile_row * tile_cols + tile_col] = table->tiles[(size_t)tile_row * table->tile_cols + tile_col];
+        }
     }
 
-    *out_cols = max_cols;
-    *out_rows = max_rows;
+    free(table->tiles);
+    table->tiles = tiles;
+
+    //every slot of the directory can hold at most one tile, so the list never has to grow while tiles are being added
+    table->tile_list = realloc(table->tile_list, sizeof(Tile*) * ((size_t)tile_rows * tile_cols > 0 ? (size_t)tile_rows * tile_cols : 1));
+    assert(table->tile_list != NULL);
+
+    reserve_colours(table, tile_rows);
+    reserve_widths(table, tile_cols);
+
+    table->tile_rows = tile_rows;
+    table->tile_cols = tile_cols;
 }
 
-Table alloc_table(int rows, int cols) {
+Tile* tile_at(Table* table, int row, int col) {
 
-    Table table = {0};
-    table.rows = rows;
-    table.cols = cols;
+    return table->tiles[(size_t)(row >> TILE_SHIFT) * table->tile_cols + (col >> TILE_SHIFT)];
+}
 
-    table.cells = malloc(sizeof(Cell) * rows * cols);
+// cells of tiles that were never written to are all the same empty cell and coloured cells all the same colour cell,
+// so this is only for reading them. cell_put gives cells that can be written to
+const Cell* cell_at(Table* table, int row, int col) {
 
-    assert(table.cells != NULL);
+    if(row < 0 || col < 0 || row >= table->rows || col >= table->cols) return NULL;
 
-    memset(table.cells, 0, sizeof(Cell) * rows * cols);
+    Tile* tile = tile_at(table, row, col);
+    const Cell* cell = tile != NULL ? &tile->cells[(row & (TILE_SIZE - 1)) * TILE_SIZE + (col & (TILE_SIZE - 1))] : &empty_cell;
 
-    return table;
+    if(cell->box == 0 && colour_at(table, row, col) != COLOUR_NONE) return &colour_cell;
+
+    return cell;
 }
 
-Cell* cell_at(Table* table, int row, int col) {
+// same as cell_at, but allocates the tile if it doesn't exist yet so the cell can be written to
+Cell* cell_put(Table* table, int row, int col) {
+
+    assert(row >= 0 && col >= 0 && row < table->rows && col < table->cols);
+
+    Tile** slot = &table->tiles[(size_t)(row >> TILE_SHIFT) * table->tile_cols + (col >> TILE_SHIFT)];
+    Tile* tile = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+
+    if(tile == NULL) {
+
+        Tile* fresh = calloc(1, sizeof(Tile));
+        assert(fresh != NULL);
+
+        fresh->row = row & ~(TILE_SIZE - 1);
+        fresh->col = col & ~(TILE_SIZE - 1);
+
+        //chunks of a parallel import can share a tile, whoever loses the race throws its copy away
+        if(__atomic_compare_exchange_n(slot, &tile, fresh, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+
+            table->tile_list[__atomic_fetch_add(&table->tile_count, 1, __ATOMIC_RELAXED)] = fresh;
+            tile = fresh;
+        }
+        else {
+
+            free(fresh);
+        }
+    }
 
-    if(row > table->rows || col > table->cols) return NULL;
-    return &table->cells[row * table->cols + col];
+    return &tile->cells[(row & (TILE_SIZE - 1)) * TILE_SIZE + (col & (TILE_SIZE - 1))];
 }
 
-void calculate_new_cell_width(Table* table) {
+void free_tiles(Table* table) {
 
-    int new_cell_width = 0;
+    for(size_t i = 0; i < table->tile_count; i++) free(table->tile_list[i]);
 
-    for(size_t row = 0; row < table->rows; row++) {
+    free(table->tile_list);
+    free(table->tiles);
+    free(table->widths);
 
-        for(size_t col = 0; col < table->cols; col++) {
+    table->tile_list = NULL;
+    table->tiles = NULL;
+    table->widths = NULL;
+    table->tile_count = 0;
+    table->tile_rows = 0;
+    table->tile_cols = 0;
+}
 
-            Cell* current_cell = cell_at(table, row, col);
-            if(current_cell->kind == KIND_TEXT) {
+size_t number_width(double number) {
 
-                if(new_cell_width < current_cell->as.text.count) new_cell_width = current_cell->as.text.count; 
-            }
-            else if(current_cell->kind == KIND_NUM) {
+    //length up to the period of "%lf", which is "%.6f"
+    char buffer[FORMAT_BUFFER_SIZE];
+    size_t length_to_period = format_fixed(number, 6, buffer);
 
-                char buffer[32];
-                memset(buffer, '\0', sizeof(buffer));
-                sprintf(buffer, "%lf", current_cell->as.number);
+    if(length_to_period > 0) {
 
-                //handling based on number being an int or double
-                size_t length_to_period = 0;
+        length_to_period -= 7;
+    }
+    else { //out of format_fixed's range, the length is all that's needed from printf
 
-                while(*(buffer + length_to_period) != '\0' && *(buffer + length_to_period) != '.') {
+        length_to_period = snprintf(NULL, 0, "%lf", number);
+        if(isfinite(number)) length_to_period -= 7;
+    }
 
-                    length_to_period++;
-                }
+    //handling based on number being an int or double
+    if(fabs(number - (int)number) > 0) { //if its a float
+        length_to_period += DECIMAL_PLACES;
+    }
 
-                if(fabs(current_cell->as.number - (int)current_cell->as.number) > 0) { //if its a float
-                    length_to_period += DECIMAL_PLACES;
-                }
-                
-                if(new_cell_width < length_to_period) new_cell_width = length_to_period;
-            }
-            else if(current_cell->kind == KIND_EXPR) {
+    return length_to_period;
+}
 
-                if(new_cell_width < current_cell->as.expression.expr.count) new_cell_width = current_cell->as.expression.expr.count;
-            }
+// right aligned in the cell, same text as "%*.*f" or "%*d" without going through printf
+void render_number(double number, int width, Writer* writer) {
+
+    char text[FORMAT_BUFFER_SIZE];
+    size_t length;
+
+    if(fabs(number - (int)number) > 0) {
+
+        length = format_fixed(number, DECIMAL_PLACES, text);
+
+        if(length == 0) { //out of format_fixed's range
+
+            writer_printf(writer, "%*.*f|", width, DECIMAL_PLACES, number);
+            return;
         }
     }
+    else {
+
+        length = format_int((int)number, text);
+    }
+
+    if((int)length < width) writer_fill(writer, ' ', width - length);
+
+    writer_append(writer, text, length);
+    writer_append(writer, "|", 1);
+}
+
+// right aligned like the numbers. columns are always wider than their widest cell, so the padding is never negative
+static void text_padding(Writer* writer, StringStruct text, int width) {
+
+    if((int)text.count < width) writer_fill(writer, ' ', width - text.count);
+}
 
-    new_cell_width += EXTRA_CELL_SPACE;
-    max_cell_width = new_cell_width;
+static void render_text(Writer* writer, StringStruct text, int width) {
+
+    text_padding(writer, text, width);
+
+    writer_append(writer, text.data, text.count);
+    writer_append(writer, "|", 1);
 }
 
-void print_cell(Cell* cell, FILE* drain) {
+void render_cell(Table* table, int row, int col, int width, Writer* writer) {
+
+    const Cell* cell = cell_at(table, row, col);
+    CellKind kind = cell_kind(cell);
+
+    if(kind != KIND_COLOUR) writer_plain(writer);
 
-    switch(cell->kind) {
+    switch(kind) {
 
         case KIND_EMPTY: {
 
-            fprintf(drain, "%*.s|", max_cell_width, " ");
+            writer_fill(writer, ' ', width);
+            writer_append(writer, "|", 1);
             return;
         }
 
         case KIND_NUM: {
             
-            if(fabs(cell->as.number - (int)cell->as.number) > 0) {
-
-                fprintf(drain, "%*.*f|", max_cell_width, DECIMAL_PLACES, cell->as.number);
-            }
-            else {
-
-                fprintf(drain, "%*d|", max_cell_width, (int)cell->as.number);
-            }
+            render_number(cell_number(cell), width, writer);
             return;
         }
 
         case KIND_TEXT: {
 
-            fprintf(drain, "%*.s"SSFormat"|", max_cell_width - (int)cell->as.text.count, " ",  SSArg(cell->as.text));
+            render_text(writer, cell_text(table, cell), width);
             return;
         }
 
         case KIND_EXPR: {
 
-            if(cell->as.expression.kind == EXPR_INVALID) {
+            if(cell_solved(cell)) { //show the solution, the formula stays in the cell
+
+                render_number(value_at(table, row, col), width, writer);
+                return;
+            }
+
+            StringStruct expr = cell_text(table, cell);
+
+            if(cell_expr_kind(cell) == EXPR_INVALID) {
 
-                if(drain == stdout) {
+                if(writer->ansi) {
 
-                    fprintf(drain, ANSI_RED "%*.s"SSFormat ANSI_RESET "|", max_cell_width - (int)cell->as.expression.expr.count, " ", SSArg(cell->as.expression.expr));
+                    writer_append(writer, ANSI_RED, sizeof(ANSI_RED) - 1);
+                    text_padding(writer, expr, width);
+                    writer_append(writer, expr.data, expr.count);
+                    writer_append(writer, ANSI_RESET "|", sizeof(ANSI_RESET "|") - 1);
                 }
                 else {
 
-                    fprintf(drain, "%*.s"SSFormat "|", max_cell_width - (int)cell->as.expression.expr.count, " ", SSArg(cell->as.expression.expr));
+                    render_text(writer, expr, width);
                 }
             } else {
 
-                fprintf(drain, "%*.s"SSFormat"|", max_cell_width - (int)cell->as.expression.expr.count, " ", SSArg(cell->as.expression.expr));
+                render_text(writer, expr, width);
             }
             
             return;
@@ -189,18 +319,7 @@ void print_cell(Cell* cell, FILE* drain) {
 
         case KIND_COLOUR: {
             
-            if(drain == stdout) {
-
-                fprintf(drain, SSFormat, SSArg(cell->as.colour));
-                for(int i = 0; i < max_cell_width; i++) printf("%s", "\u2588");
-                fprintf(drain, ANSI_RESET"|");
-            }
-            else {
-
-                for(int i = 0; i < max_cell_width; i++) fprintf(drain, "%c", '#');
-                fprintf(drain, "|");
-            }
-
+            render_colour_run(writer, colour_at(table, row, col), &width, 1);
             break;
         }
 
@@ -211,9 +330,9 @@ void print_cell(Cell* cell, FILE* drain) {
     }
 }
 
-void print_cell_kind(Cell* cell) {
+void print_cell_kind(const Cell* cell) {
 
-    switch(cell->kind) {
+    switch(cell_kind(cell)) {
 
         case KIND_EMPTY: {
 
@@ -235,9 +354,9 @@ void print_cell_kind(Cell* cell) {
 
         case KIND_EXPR: {
 
-            if(cell->as.expression.kind == EXPR_DEFAULT)
+            if(cell_expr_kind(cell) == EXPR_DEFAULT)
                 printf("%*s|", 5, "EXPR");
-            else if(cell->as.expression.kind == EXPR_VALID)
+            else if(cell_expr_kind(cell) == EXPR_VALID)
                 printf("%*s|", 5, "EXPR+");
             else
                 printf("%*s|", 5, "EXPR-");
@@ -258,143 +377,413 @@ void print_cell_kind(Cell* cell) {
     }
 }
 
-bool is_colour(StringStruct token_copy, StringStruct* out_colour) {
+// classifies the token and stores it in the cell. import and modify both go through here, so they read a token the same way.
+// text is interned into strings, which is the table's pool or the pool of an import chunk that merge_chunks folds into it
+CellKind fill_cell(Table* table, int row, int col, StringStruct token, StringPool* strings) {
 
-    if(!ss_starts_with(&token_copy, '#')) return false;
+    TokenClass class = classify_token(token);
 
-    ss_cut_n(&token_copy, 1);
+    if(class.kind == KIND_COLOUR) { //colours live in their own layer, they don't need a tile
 
-    if(ss_cmp_cstr(&token_copy, "RED")) {
+        Tile* tile = __atomic_load_n(&table->tiles[(size_t)(row >> TILE_SHIFT) * table->tile_cols + (col >> TILE_SHIFT)], __ATOMIC_ACQUIRE);
 
-        *out_colour = SS(ANSI_RED);
-        return true;
-    }
-    else if(ss_cmp_cstr(&token_copy, "GREEN")) {
+        if(tile != NULL) { //the width stays until the cell's column is told about the change
+
+            Cell* cell = &tile->cells[(row & (TILE_SIZE - 1)) * TILE_SIZE + (col & (TILE_SIZE - 1))];
+            *cell = (Cell){ .width = cell->width };
+            clear_value(table, row, col);
+        }
 
-        *out_colour = SS(ANSI_GREEN);
-        return true;
+        set_colour(table, row, col, class.colour);
+        return KIND_COLOUR;
     }
-    else if(ss_cmp_cstr(&token_copy, "YELLOW")) {
 
-        *out_colour = SS(ANSI_YELLOW);
-        return true;
+    Cell* cell = cell_put(table, row, col);
+    set_colour(table, row, col, COLOUR_NONE);
+
+    if(class.kind == KIND_NUM) {
+
+        union { double number; uint64_t bits; } raw = { .number = class.number };
+
+        cell->box = raw.bits ^ CELL_BOX_TAG;
+        cell->length = 0;
+        store_value(table, row, col, class.number);
+
+        return KIND_NUM;
     }
-    else if(ss_cmp_cstr(&token_copy, "BLUE")) {
 
-        *out_colour = SS(ANSI_BLUE);
-        return true;
+    clear_value(table, row, col);
+
+    uint64_t box = CELL_BOX_TAG | ((uint64_t)class.kind << CELL_KIND_SHIFT);
+    uint32_t index = 0;
+
+    bool in_file = table->mapping != NULL && token.data >= table->mapping && token.data <= table->mapping + table->mapping_size;
+
+    if(in_file && class.kind == KIND_EXPR) { //formulas are only ever parsed, so imported ones are left in the file
+
+        index = (uint32_t)(token.data - table->mapping);
     }
-    else if(ss_cmp_cstr(&token_copy, "MAGENTA")) {
+    else if(token.count > 0) {
 
-        *out_colour = SS(ANSI_MAGENTA);
-        return true;
+        index = pool_intern(strings, token.data, token.count);
+        box |= CELL_POOLED_BIT;
     }
-    else if(ss_cmp_cstr(&token_copy, "CYAN")) {
 
-        *out_colour = SS(ANSI_CYAN);
-        return true;
+    //expressions start out as EXPR_DEFAULT and unsolved, both of which are zero bits
+    cell->box = (box | index) ^ CELL_BOX_TAG;
+    cell->length = (uint32_t)token.count;
+
+    return class.kind;
+}
+
+// text of a text cell or formula of an expression cell
+StringStruct cell_text(Table* table, const Cell* cell) {
+
+    if(cell->length == 0) return ss_form_string("", 0); //empty cells, including the ones of tiles that don't exist
+    if(cell->box & CELL_POOLED_BIT) return pool_string(&table->strings, cell_index(cell));
+
+    return ss_form_string(table->mapping + cell_index(cell), cell->length);
+}
+
+// cuts the next line of the chunk into its cells and returns how many there are. only the first capacity cells are written to tokens
+static size_t cut_line(ImportChunk* chunk, size_t* next, size_t* start, StringStruct* tokens, size_t capacity) {
+
+    StringStruct input = chunk->input;
+    size_t count = 0;
+
+    while(true) {
+
+        size_t end = *next < chunk->index.count ? chunk->index.offsets[(*next)++] : input.count;
+        bool last = end == input.count || input.data[end] == '\n';
+
+        //a line ending right after a '|' doesn't have another cell, same as an empty line
+        if(!(last && end == *start)) {
+
+            if(count < capacity) tokens[count] = ss_trim(ss_form_string((char*)input.data + *start, end - *start));
+            count++;
+        }
+
+        *start = end + 1;
+        if(last) return count;
     }
-    else if(ss_cmp_cstr(&token_copy, "BLACK")) {
+}
+
+// finds the delimiters of the chunk and counts its rows and columns, nothing is written to the table yet
+void index_chunk(ImportChunk* chunk) {
+
+    //every delimiter is found up front, lines and cells are then sliced straight from their offsets
+    chunk->index = build_structural_index(chunk->input.data, chunk->input.count);
+    chunk->rows = 0;
+    chunk->cols = 0;
+
+    size_t next = 0;
+    size_t start = 0;
 
-        *out_colour = SS(ANSI_BLACK);
-        return true;
+    while(start < chunk->input.count) {
+
+        int cols = (int)cut_line(chunk, &next, &start, NULL, 0);
+        if(cols > chunk->cols) chunk->cols = cols;
+
+        chunk->rows++;
     }
-    else if(ss_cmp_cstr(&token_copy, "WHITE")) {
+}
+
+static void import_cell(Table* table, ImportChunk* chunk, int row, int col, StringStruct token) {
+
+    if(token.count == 0) return; //cells start out empty, no need to allocate a tile for one
+
+    CellKind kind = fill_cell(table, row, col, token, &chunk->strings);
 
-        *out_colour = SS(ANSI_WHITE);
-        return true;
+    //nothing is solved yet, so the width only depends on the cell. columns are counted once every chunk is in
+    if(kind != KIND_COLOUR) {
+
+        Cell* cell = cell_put(table, row, col);
+        cell->width = cell_width(table, cell, row, col);
     }
-    else return false;
+
+    if(kind == KIND_EXPR) chunk->expressions++;
 }
-// values last as long as "char* content" lasts.
-void populate_table(Table* table, StringStruct input) {
 
-    for(int rows = 0; input.count > 0; rows++) {
+// fills rows first_row onwards from an indexed chunk. chunks cover different rows, so they can be filled at the same time.
+// a chunk that wasn't counted grows the table line by line instead, which only the single threaded import does
+void populate_chunk(Table* table, ImportChunk* chunk) {
+
+    size_t capacity = chunk->cols > 0 ? (size_t)chunk->cols : 16;
+    StringStruct* tokens = malloc(sizeof(StringStruct) * capacity);
+    assert(tokens != NULL);
+
+    size_t next = 0;
+    size_t start = 0;
+
+    chunk->expressions = 0;
+
+    for(int row = chunk->first_row; start < chunk->input.count; row++) {
+
+        size_t line_next = next;
+        size_t line_start = start;
+        size_t count = cut_line(chunk, &next, &start, tokens, capacity);
 
-        StringStruct line = ss_cut_by_delim(&input, '\n');
+        if(chunk->grow) {
 
-        for(int cols = 0; line.count > 0; cols++) {
+            chunk->status = check_dimensions(row + 1, (int)count);
+            if(chunk->status != IMPORT_OK) break;
 
-            StringStruct token = ss_trim(ss_cut_by_delim(&line, '|'));
-            StringStruct colour = SS("");
+            //the line is cut again in the rare case it is wider than any line so far
+            if(count > capacity) {
 
-            if(is_colour(token, &colour)) {
+                while(capacity < count) capacity *= 2;
+                tokens = realloc(tokens, sizeof(StringStruct) * capacity);
+                assert(tokens != NULL);
 
-                cell_at(table, rows, cols)->kind = KIND_COLOUR;
-                cell_at(table, rows, cols)->as.colour = colour;
+                cut_line(chunk, &line_next, &line_start, tokens, capacity);
             }
-            else if(ss_starts_with(&token, '=')) {
 
-                if(token.count > max_cell_width) max_cell_width = token.count;
+            //growing only allocates tile pointers, tiles are made as cells are filled
+            reserve_table(table, row + 1, (int)count);
+            if(row + 1 > table->rows) table->rows = row + 1;
+            chunk->rows++;
+        }
+
+        for(size_t col = 0; col < count; col++) {
 
-                cell_at(table, rows, cols)->as.expression.expr = token;
-                cell_at(table, rows, cols)->as.expression.kind = EXPR_DEFAULT;
-                cell_at(table, rows, cols)->kind = KIND_EXPR;
-                expression_count++;
-            } else if(ss_isnumber(token)) {
+            import_cell(table, chunk, row, (int)col, tokens[col]);
+        }
+    }
 
-                if(token.count > max_cell_width) max_cell_width = token.count;
+    free(tokens);
+    free_structural_index(&chunk->index);
+}
 
-                cell_at(table, rows, cols)->as.number = ss_tod(token);
-                cell_at(table, rows, cols)->kind = KIND_NUM;
-            } else {
+// folds the chunk's pool into the table's and points the chunk's text cells at the ids the table's pool gave them
+static void merge_strings(Table* table, ImportChunk* chunk) {
 
-                if(token.count > max_cell_width) max_cell_width = token.count;
+    StringPool* strings = &chunk->strings;
 
-                cell_at(table, rows, cols)->as.text = token;
-                if(token.count == 0)
-                    cell_at(table, rows, cols)->kind = KIND_EMPTY;
-                else
-                    cell_at(table, rows, cols)->kind = KIND_TEXT;
+    if(strings->count == 0) {
+
+        pool_free(strings);
+        return;
+    }
+
+    if(table->strings.count == 0) { //the first chunk with text becomes the table's pool, its ids stay as they are
+
+        pool_free(&table->strings);
+        table->strings = *strings;
+        *strings = (StringPool){0};
+        return;
+    }
+
+    uint32_t* ids = malloc(sizeof(uint32_t) * strings->count);
+    assert(ids != NULL);
+
+    for(uint32_t id = 0; id < strings->count; id++) {
+
+        StringStruct text = pool_string(strings, id);
+        ids[id] = pool_intern(&table->strings, text.data, text.count);
+    }
+
+    for(int row = chunk->first_row; row < chunk->first_row + chunk->rows; row++) {
+
+        for(int tile_col = 0; tile_col < table->tile_cols; tile_col++) {
+
+            Tile* tile = tile_at(table, row, tile_col << TILE_SHIFT);
+            if(tile == NULL) continue;
+
+            for(int col = 0; col < TILE_SIZE; col++) {
+
+                Cell* cell = &tile->cells[(row & (TILE_SIZE - 1)) * TILE_SIZE + col];
+                if(cell_kind(cell) != KIND_TEXT || !(cell->box & CELL_POOLED_BIT)) continue;
+
+                cell->box = (cell->box & ~(uint64_t)UINT32_MAX) | ids[cell_index(cell)]; //the tag has no bits in the index
             }
         }
     }
 
-    max_cell_width += EXTRA_CELL_SPACE;
+    free(ids);
+    pool_free(strings);
 }
 
-void print_table(Table* table, FILE* drain) {
+// the expression counts and text of every chunk end up in the table
+void merge_chunks(Table* table, ImportChunk* chunks, int count) {
 
-    fprintf(drain, "\n LE |");
+    for(int i = 0; i < count; i++) {
 
-    int left_padding = 0;
-    int right_padding = 0;
+        table->expression_count += chunks[i].expressions;
+        merge_strings(table, &chunks[i]);
+    }
+}
 
-    if(max_cell_width % 2) {
+// cells point into the input, so they last as long as it does
+ImportStatus populate_table(Table* table, StringStruct input) {
 
-        left_padding = max_cell_width / 2;
-        right_padding = max_cell_width / 2;
-        
-    } else {
+    if(solve_thread_count > 1 && input.count >= PARALLEL_IMPORT_THRESHOLD) {
+
+        return populate_table_parallel(table, input, solve_thread_count);
+    }
+
+    ImportChunk chunk = {0};
+    chunk.input = input;
+    chunk.first_row = table->rows;
+    chunk.grow = true;
+
+    //a single thread fills as it reads, only the parallel import needs every chunk counted first
+    chunk.index = build_structural_index(input.data, input.count);
+
+    populate_chunk(table, &chunk);
+    merge_chunks(table, &chunk, 1);
+
+    return chunk.status;
+}
 
+// whether a table of rows x cols is within the limits every table is held to
+ImportStatus check_dimensions(int rows, int cols) {
 
-        left_padding = max_cell_width / 2 - 1;
-        right_padding = max_cell_width / 2;
+    if(rows > TABLE_MAX_ROWS) return IMPORT_TOO_MANY_ROWS;
+    if(cols > TABLE_MAX_COLS) return IMPORT_TOO_MANY_COLS;
+
+    return IMPORT_OK;
+}
+
+// spreadsheet style column name, A to Z, then AA to ZZ, then AAA onwards. returns the buffer it was written to
+char* column_name(int col, char* out) {
+
+    char reversed[COLUMN_NAME_SIZE];
+    int length = 0;
+
+    for(int n = col + 1; n > 0; n = (n - 1) / 26) {
+
+        assert(length < COLUMN_NAME_SIZE - 1);
+        reversed[length++] = (char)('A' + (n - 1) % 26);
+    }
+
+    for(int i = 0; i < length; i++) out[i] = reversed[length - 1 - i];
+    out[length] = '\0';
+
+    return out;
+}
+
+// row numbers get at least three characters, more once the table is tall enough to need them
+static int row_label_width(Table* table) {
+
+    int width = 1;
+    for(int rows = table->rows - 1; rows >= 10; rows /= 10) width++;
+
+    return width > 3 ? width : 3;
+}
+
+// every column is as wide as its widest cell plus some space, and never narrower than its name
+static int* layout_columns(Table* table, int* out_widest) {
+
+    int* widths = malloc(sizeof(int) * (table->cols > 0 ? table->cols : 1));
+    assert(widths != NULL);
+
+    char name[COLUMN_NAME_SIZE];
+    *out_widest = MIN_CELL_WIDTH;
+
+    for(int col = 0; col < table->cols; col++) {
+
+        int width = (int)widest_in_column(table, col) + EXTRA_CELL_SPACE;
+        int length = (int)strlen(column_name(col, name));
+
+        if(width < MIN_CELL_WIDTH) width = MIN_CELL_WIDTH;
+        if(width < length) width = length;
+        if(width > *out_widest) *out_widest = width;
+
+        widths[col] = width;
     }
 
-    for(int i = 0; i < table->cols; i++) { // columns header
+    return widths;
+}
+
+void print_table(Table* table, FILE* drain) {
+
+    int widest;
+    int* widths = layout_columns(table, &widest);
+    int label_width = row_label_width(table);
+    int line_width = label_width + 2;
+    char name[COLUMN_NAME_SIZE];
+    char label[FORMAT_BUFFER_SIZE];
+
+    for(int col = 0; col < table->cols; col++) line_width += widths[col] + 1;
 
-        fprintf(drain, "%*s%c%*s|", left_padding, " ", 'A' + i, right_padding, " ");
+    Writer writer = make_writer(drain);
+    build_glyphs(&writer, widest);
+
+    writer_append(&writer, "\n", 1);
+    writer_fill(&writer, ' ', label_width - 2);
+    writer_append(&writer, "LE |", 4);
+
+    for(int i = 0; i < table->cols; i++) { // columns header, names are centered and lean left when they can't be
+
+        int length = (int)strlen(column_name(i, name));
+        int left_padding = widths[i] > length ? (widths[i] - length) / 2 : 0;
+        int right_padding = widths[i] > length ? widths[i] - length - left_padding : 0;
+
+        writer_fill(&writer, ' ', left_padding);
+        writer_append(&writer, name, length);
+        writer_fill(&writer, ' ', right_padding);
+        writer_append(&writer, "|", 1);
     }
 
-    fprintf(drain, "\n");
-    for(int i = 0; i < table->cols * (max_cell_width + 1) + 5; i++) fprintf(drain, "%c", '-'); //line separator
-    fprintf(drain, "\n");
+    writer_append(&writer, "\n", 1);
+    writer_fill(&writer, '-', line_width); //line separator
+    writer_append(&writer, "\n", 1);
 
     for(int row = 0; row < table->rows; row++) {
 
-        fprintf(drain, "|%*d|", 3, row); //row separator
+        size_t length = format_int(row, label); //row separator
+
+        writer_append(&writer, "|", 1);
+        writer_fill(&writer, ' ', label_width - length);
+        writer_append(&writer, label, length);
+        writer_append(&writer, "|", 1);
+
+        ColourRow* colours = colour_row(table, row);
+        int run = 0;
 
         for(int col = 0; col < table->cols; col++) {
 
-            print_cell(cell_at(table, row, col), drain);
+            if(colours != NULL && run < colours->count && (int)colours->runs[run].col == col) { //whole run at once
+
+                render_colour_run(&writer, (ColourId)(colours->runs[run].colour + 1), widths + col, colours->runs[run].length);
+
+                col += colours->runs[run].length - 1;
+                run++;
+                continue;
+            }
+
+            Tile* tile = tile_at(table, row, col);
+
+            if(tile == NULL) { //the rest of the tile's row is empty up to the next run, no need to look its cells up
+
+                int end = (col | (TILE_SIZE - 1)) + 1;
+                if(end > table->cols) end = table->cols;
+                if(colours != NULL && run < colours->count && (int)colours->runs[run].col < end) end = colours->runs[run].col;
+
+                writer_plain(&writer);
+
+                for(; col < end; col++) {
+
+                    writer_fill(&writer, ' ', widths[col]);
+                    writer_append(&writer, "|", 1);
+                }
+
+                col--;
+                continue;
+            }
+
+            render_cell(table, row, col, widths[col], &writer);
         }
-        fprintf(drain, "\n");
+
+        writer_plain(&writer);
+        writer_append(&writer, "\n", 1);
     }
-    
 
-    for(int i = 0; i < table->cols * (max_cell_width + 1) + 5; i++) fprintf(drain, "%c", '-'); //line separator
-    fprintf(drain, "\n");
+    writer_fill(&writer, '-', line_width); //line separator
+    writer_append(&writer, "\n", 1);
+
+    free_writer(&writer);
+    free(widths);
 }
 
 void print_table_kind(Table* table) {
@@ -423,22 +812,33 @@ bool token_iscellref(Table* table, StringStruct token, int* out_row, int* out_co
 
     StringStruct input = ss_trim(token);
 
-    char c = *((char*)(ss_cut_n(&input, 1).data));
-    if(!c_isupper(c)) goto not;
+    //one to three letters naming the column, the row right after them
+    int column = 0;
+    size_t letters = 0;
+
+    while(letters < input.count && c_isupper(input.data[letters])) {
+
+        if(letters == COLUMN_NAME_SIZE - 1) goto not; //too many letters for a column, and column would overflow
+
+        column = column * 26 + (input.data[letters] - 'A' + 1);
+        letters++;
+    }
 
-    if(!ss_isnumber(input)) goto not;
+    if(letters == 0) goto not;
+    column--;
 
-    int num = (int)ss_tod(input);
+    ss_cut_n(&input, letters);
 
-    if(num < 0 || num > 999) goto not;
+    int num = 0;
+    if(!ss_toi(input, &num)) goto not;
 
+    if(column >= TABLE_MAX_COLS || num >= TABLE_MAX_ROWS) goto not;
 
-    int column = (int)(c - 'A');
     if(column >= table->cols) goto out_of_bounds_col;
     if(num >= table->rows) goto out_of_bounds_row;
 
 
-    if(out_column) *out_column = (int)(c - 'A');
+    if(out_column) *out_column = column;
     if(out_row) *out_row = num;
 
     return true;
@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <assert.h>
+
+#include "writer.h"
+#include "constants.h"
+
+Writer make_writer(FILE* drain) {
+
+    Writer writer = { .drain = drain, .ansi = drain == stdout, .capacity = WRITER_BLOCK_SIZE };
+
+    writer.data = malloc(writer.capacity);
+    assert(writer.data != NULL);
+
+    return writer;
+}
+
+// full blocks are written out first, the buffer only grows for a single piece bigger than a block
+char* writer_make_room(Writer* writer, size_t count) {
+
+    writer_flush(writer);
+
+    if(count > writer->capacity) {
+
+        writer->capacity = count;
+        writer->data = realloc(writer->data, writer->capacity);
+        assert(writer->data != NULL);
+    }
+
+    return writer->data;
+}
+
+// for what there is no faster way to write
+void writer_printf(Writer* writer, const char* format, ...) {
+
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    assert(length >= 0);
+    char* out = writer_reserve(writer, (size_t)length + 1); //vsnprintf always writes the terminator
+
+    va_start(args, format);
+    vsnprintf(out, (size_t)length + 1, format, args);
+    va_end(args);
+
+    writer->count += length;
+}
+
+// leaves the colour of the last run, everything that isn't a colour run is written uncoloured
+void writer_plain(Writer* writer) {
+
+    if(writer->colour == 0) return;
+
+    writer_append(writer, ANSI_RESET, sizeof(ANSI_RESET) - 1);
+    writer->colour = 0;
+}
+
+void writer_flush(Writer* writer) {
+
+    if(writer->count > 0) fwrite(writer->data, 1, writer->count, writer->drain);
+    writer->count = 0;
+}
+
+void free_writer(Writer* writer) {
+
+    writer_flush(writer);
+
+    free(writer->data);
+    free(writer->glyphs);
+
+    *writer = (Writer){0};
+}